@@ -1,4 +1,4 @@
-#version 330 core
+#version 430 core
 out vec4 FragColor;
 
 in vec2 textureCordinates;
@@ -15,13 +15,30 @@ struct Sphere {
 	int material; // DIFFUSE = 0, REFLECTION = 1, REFRACTION = 2
 };
 
+struct Plane {
+	vec3 origin;
+	vec3 normal;
+	vec4 colour;
+	int material;
+};
+
+struct Disc {
+	vec3 origin;
+	vec3 normal;
+	float radius;
+	vec4 colour;
+	int material;
+};
+
 struct DirectionalLight {
 	vec3 direction;
 };
 
 struct Hit {
 	bool hitSomething;
-	Sphere hitSphere;
+	vec3 normal;
+	vec4 colour;
+	int material;
 	float distanceToHit;
 };
 
@@ -29,11 +46,26 @@ struct Hit {
 uniform vec3 cameraPosition;
 uniform vec3 cameraDirection;
 
-uniform Sphere spheres[32];
-uniform int numberOfSpheres;
+// Scene, laid out by ScenePacking.cpp
+layout(std430, binding = 0) readonly buffer SphereBuffer {
+	int numberOfSpheres;
+	Sphere spheres[];
+};
+
+layout(std430, binding = 1) readonly buffer PlaneBuffer {
+	int numberOfPlanes;
+	Plane planes[];
+};
+
+layout(std430, binding = 2) readonly buffer DiscBuffer {
+	int numberOfDiscs;
+	Disc discs[];
+};
 
-uniform DirectionalLight dirLights[8];
-uniform int numberOfdirectionalLights;
+layout(std430, binding = 3) readonly buffer DirectionalLightBuffer {
+	int numberOfdirectionalLights;
+	DirectionalLight dirLights[];
+};
 
 uniform float aspectRatio;
 uniform int pixelWidth;
@@ -81,7 +113,16 @@ vec3 randomVec3InUnitSphere(float seed) {
 	}
 }
 
-Hit hitSphere(Ray ray) {
+// Distance along the ray to an infinite plane, negative when the ray is parallel or facing away
+float hitPlaneDistance(Ray ray, vec3 origin, vec3 normal) {
+	float denominator = dot(ray.direction, normal);
+	if (abs(denominator) < 0.000001) {
+		return -1.0;
+	}
+	return dot(origin - ray.origin, normal) / denominator;
+}
+
+Hit hitScene(Ray ray) {
 	Hit sphereHit;
 	sphereHit.hitSomething = false;
 	sphereHit.distanceToHit = FLT_MAX;
@@ -107,10 +148,43 @@ Hit hitSphere(Ray ray) {
 
 		if (hitDistance < sphereHit.distanceToHit) {
 			sphereHit.distanceToHit = hitDistance;
-			sphereHit.hitSphere = spheres[i];
+			sphereHit.normal = normalize(at(ray, sphereHit.distanceToHit) - spheres[i].origin);
+			sphereHit.colour = spheres[i].colour;
+			sphereHit.material = spheres[i].material;
 			sphereHit.hitSomething = true;
 		}
 	}
+
+	for (int i = 0; i < numberOfPlanes; i++) {
+		float hitDistance = hitPlaneDistance(ray, planes[i].origin, planes[i].normal);
+		if (hitDistance < 0.001 || hitDistance >= sphereHit.distanceToHit) {
+			continue;
+		}
+
+		sphereHit.distanceToHit = hitDistance;
+		sphereHit.normal = faceforward(planes[i].normal, ray.direction, planes[i].normal);
+		sphereHit.colour = planes[i].colour;
+		sphereHit.material = planes[i].material;
+		sphereHit.hitSomething = true;
+	}
+
+	for (int i = 0; i < numberOfDiscs; i++) {
+		float hitDistance = hitPlaneDistance(ray, discs[i].origin, discs[i].normal);
+		if (hitDistance < 0.001 || hitDistance >= sphereHit.distanceToHit) {
+			continue;
+		}
+
+		vec3 offset = at(ray, hitDistance) - discs[i].origin;
+		if (dot(offset, offset) > discs[i].radius * discs[i].radius) {
+			continue;
+		}
+
+		sphereHit.distanceToHit = hitDistance;
+		sphereHit.normal = faceforward(discs[i].normal, ray.direction, discs[i].normal);
+		sphereHit.colour = discs[i].colour;
+		sphereHit.material = discs[i].material;
+		sphereHit.hitSomething = true;
+	}
 	return sphereHit;
 }
 
@@ -154,15 +228,15 @@ void main() {
 		vec3 tempColour = vec3(0);
 		float multiplier = 1.0;
 		for (int i = 0; i < maxNumberOfBounces; i++) {
-			Hit hit = hitSphere(ray);
+			Hit hit = hitScene(ray);
 
 			if (hit.hitSomething == false) { // Miss
 				tempColour += backgroundColour * multiplier;
 				break;
 			}
 
-			vec3 hitLocation = ray.origin + ray.direction * hit.distanceToHit;
-			vec3 normal = normalize(hitLocation - hit.hitSphere.origin);
+			vec3 hitLocation = at(ray, hit.distanceToHit);
+			vec3 normal = hit.normal;
 
 			float lightIntensity = 0.0;
 			for (int i = 0; i < numberOfdirectionalLights; i++) {
@@ -171,13 +245,13 @@ void main() {
 			
 			lightIntensity = clamp(lightIntensity, 0.0, 1.0);
 
-			tempColour += hit.hitSphere.colour.xyz * multiplier * lightIntensity;
+			tempColour += hit.colour.xyz * multiplier * lightIntensity;
 			multiplier *= 0.5;
 
-			if (hit.hitSphere.material == 0) {
+			if (hit.material == 0) {
 				ray = scatterRayDiffuse(ray, hit, hitLocation, normal, cos(randSeed + sin(1234.5678)));
 			}
-			else if (hit.hitSphere.material == 1) {
+			else if (hit.material == 1) {
 				ray = scatterRayReflective(ray, hit, hitLocation, normal);
 			}
 		}
@@ -0,0 +1,404 @@
+#include "SphereBVH.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace Rhodochrosite {
+	namespace {
+		constexpr unsigned int maximumLeafSize = 4;
+		constexpr unsigned int binCount = 12;
+
+		// Below this depth splits fall back to the median, which keeps every tree within the traversal stack
+		constexpr unsigned int medianSplitDepth = 40;
+		constexpr unsigned int traversalStackSize = 96;
+
+		struct Bounds {
+			Malachite::Vector3f min{ std::numeric_limits<float>::max() };
+			Malachite::Vector3f max{ -std::numeric_limits<float>::max() };
+
+			void grow(const Malachite::Vector3f& pointMin, const Malachite::Vector3f& pointMax) {
+				min = Malachite::Vector3f{ std::min(min.x, pointMin.x), std::min(min.y, pointMin.y), std::min(min.z, pointMin.z) };
+				max = Malachite::Vector3f{ std::max(max.x, pointMax.x), std::max(max.y, pointMax.y), std::max(max.z, pointMax.z) };
+			}
+
+			void grow(const Bounds& other) { grow(other.min, other.max); }
+
+			[[nodiscard]] float area() const {
+				const Malachite::Vector3f extent = max - min;
+				if (extent.x < 0.0f) {
+					return 0.0f;
+				}
+				return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+			}
+		};
+
+		Bounds sphereBounds(const Sphere& sphere) {
+			return Bounds{ sphere.origin - Malachite::Vector3f{ sphere.radius }, sphere.origin + Malachite::Vector3f{ sphere.radius } };
+		}
+
+		float component(const Malachite::Vector3f& vector, const int axis) {
+			return axis == 0 ? vector.x : (axis == 1 ? vector.y : vector.z);
+		}
+
+		float nodeArea(const SphereBVH::Node& node) {
+			return Bounds{ node.min, node.max }.area();
+		}
+
+		// Area weighted cost of a node, intersection tests on spheres and traversal steps cost the same
+		float nodeCost(const SphereBVH::Node& node) {
+			return nodeArea(node) * static_cast<float>(node.count == 0 ? 1 : node.count);
+		}
+
+		class Builder {
+		public:
+			Builder(const std::vector<Sphere>& spheres, std::vector<SphereBVH::Node>& nodes, std::vector<unsigned int>& indices)
+				: m_Spheres(spheres)
+				, m_Nodes(nodes)
+				, m_Indices(indices) { }
+
+			void buildNode(const unsigned int first, const unsigned int count, const unsigned int depth) {
+				const auto index = static_cast<unsigned int>(m_Nodes.size());
+				m_Nodes.emplace_back();
+
+				Bounds bounds{};
+				Bounds centroids{};
+				for (unsigned int i = first; i < first + count; i++) {
+					const Sphere& sphere = m_Spheres[m_Indices[i]];
+					const Bounds box = sphereBounds(sphere);
+					bounds.grow(box);
+					centroids.grow(sphere.origin, sphere.origin);
+				}
+				m_Nodes[index].min = bounds.min;
+				m_Nodes[index].max = bounds.max;
+
+				unsigned int leftCount = 0;
+				if (count > maximumLeafSize) {
+					leftCount = depth < medianSplitDepth ? partition(first, count, bounds, centroids) : medianSplit(first, count, centroids);
+				}
+
+				if (leftCount == 0) {
+					m_Nodes[index].rightOrFirst = first;
+					m_Nodes[index].count = count;
+					return;
+				}
+
+				buildNode(first, leftCount, depth + 1);
+				m_Nodes[index].rightOrFirst = static_cast<unsigned int>(m_Nodes.size());
+				buildNode(first + leftCount, count - leftCount, depth + 1);
+			}
+
+		private:
+			const std::vector<Sphere>& m_Spheres;
+			std::vector<SphereBVH::Node>& m_Nodes;
+			std::vector<unsigned int>& m_Indices;
+
+			// Binned surface area heuristic split, returns how many spheres go left or 0 when a leaf is cheaper
+			unsigned int partition(const unsigned int first, const unsigned int count, const Bounds& bounds, const Bounds& centroids) {
+				float bestCost = std::numeric_limits<float>::max();
+				int bestAxis = -1;
+				unsigned int bestSplit = 0;
+
+				for (int axis = 0; axis < 3; axis++) {
+					const float axisMin = component(centroids.min, axis);
+					const float extent = component(centroids.max, axis) - axisMin;
+					if (extent <= 0.0f) {
+						continue;
+					}
+
+					Bounds bins[binCount]{};
+					unsigned int binSizes[binCount]{};
+					const float scale = static_cast<float>(binCount) / extent;
+					for (unsigned int i = first; i < first + count; i++) {
+						const Sphere& sphere = m_Spheres[m_Indices[i]];
+						const auto bin = std::min(static_cast<unsigned int>((component(sphere.origin, axis) - axisMin) * scale), binCount - 1);
+						bins[bin].grow(sphereBounds(sphere));
+						binSizes[bin]++;
+					}
+
+					// Sweep from the right to get the cost of every right hand side, then from the left
+					float rightAreas[binCount]{};
+					unsigned int rightCounts[binCount]{};
+					Bounds right{};
+					unsigned int rightCount = 0;
+					for (unsigned int bin = binCount - 1; bin > 0; bin--) {
+						right.grow(bins[bin]);
+						rightCount += binSizes[bin];
+						rightAreas[bin] = right.area();
+						rightCounts[bin] = rightCount;
+					}
+
+					Bounds left{};
+					unsigned int leftCount = 0;
+					for (unsigned int split = 1; split < binCount; split++) {
+						left.grow(bins[split - 1]);
+						leftCount += binSizes[split - 1];
+						if (leftCount == 0 || rightCounts[split] == 0) {
+							continue;
+						}
+
+						const float cost = left.area() * static_cast<float>(leftCount) + rightAreas[split] * static_cast<float>(rightCounts[split]);
+						if (cost < bestCost) {
+							bestCost = cost;
+							bestAxis = axis;
+							bestSplit = split;
+						}
+					}
+				}
+
+				if (bestAxis < 0) {
+					// Every centre is in the same place, split down the middle so leaves stay small
+					return medianSplit(first, count, centroids);
+				}
+
+				const float leafCost = bounds.area() * static_cast<float>(count);
+				if (count <= maximumLeafSize * 4 && bestCost + bounds.area() >= leafCost) {
+					return 0;
+				}
+
+				const float axisMin = component(centroids.min, bestAxis);
+				const float scale = static_cast<float>(binCount) / (component(centroids.max, bestAxis) - axisMin);
+				const auto middle = std::partition(m_Indices.begin() + first, m_Indices.begin() + first + count, [&](const unsigned int sphere) {
+					const auto bin = std::min(static_cast<unsigned int>((component(m_Spheres[sphere].origin, bestAxis) - axisMin) * scale), binCount - 1);
+					return bin < bestSplit;
+				});
+
+				return static_cast<unsigned int>(middle - (m_Indices.begin() + first));
+			}
+
+			unsigned int medianSplit(const unsigned int first, const unsigned int count, const Bounds& centroids) {
+				const Malachite::Vector3f extent = centroids.max - centroids.min;
+				int axis = 0;
+				if (extent.y > component(extent, axis)) { axis = 1; }
+				if (extent.z > component(extent, axis)) { axis = 2; }
+
+				const unsigned int half = count / 2;
+				std::nth_element(m_Indices.begin() + first, m_Indices.begin() + first + half, m_Indices.begin() + first + count, [&](const unsigned int a, const unsigned int b) {
+					return component(m_Spheres[a].origin, axis) < component(m_Spheres[b].origin, axis);
+				});
+				return half;
+			}
+		};
+
+		// Refits nodes [first, last) of one subtree, children always come after their parent
+		float refitRange(std::vector<SphereBVH::Node>& nodes, const std::vector<unsigned int>& indices, const std::vector<Sphere>& spheres, const unsigned int first, const unsigned int last) {
+			float cost = 0.0f;
+			for (unsigned int i = last; i-- > first;) {
+				SphereBVH::Node& node = nodes[i];
+
+				Bounds bounds{};
+				if (node.count != 0) {
+					for (unsigned int sphere = node.rightOrFirst; sphere < node.rightOrFirst + node.count; sphere++) {
+						bounds.grow(sphereBounds(spheres[indices[sphere]]));
+					}
+				}
+				else {
+					bounds.grow(nodes[i + 1].min, nodes[i + 1].max);
+					bounds.grow(nodes[node.rightOrFirst].min, nodes[node.rightOrFirst].max);
+				}
+
+				node.min = bounds.min;
+				node.max = bounds.max;
+				cost += nodeCost(node);
+			}
+			return cost;
+		}
+
+		float relativeCost(const std::vector<SphereBVH::Node>& nodes, const float totalCost) {
+			const float rootArea = nodeArea(nodes.front());
+			return rootArea > 0.0f ? totalCost / rootArea : 0.0f;
+		}
+	}
+
+	std::shared_ptr<const SphereBVH> SphereBVH::build(const std::vector<Sphere>& spheres) {
+		auto bvh = std::make_shared<SphereBVH>();
+
+		auto indices = std::make_shared<std::vector<unsigned int>>(spheres.size());
+		std::iota(indices->begin(), indices->end(), 0u);
+
+		if (!spheres.empty()) {
+			bvh->m_Nodes.reserve(spheres.size() * 2 / maximumLeafSize + 1);
+			Builder{ spheres, bvh->m_Nodes, *indices }.buildNode(0, static_cast<unsigned int>(spheres.size()), 0);
+
+			float totalCost = 0.0f;
+			for (const Node& node : bvh->m_Nodes) {
+				totalCost += nodeCost(node);
+			}
+			bvh->m_Cost = relativeCost(bvh->m_Nodes, totalCost);
+		}
+
+		bvh->m_Indices = std::move(indices);
+		bvh->m_BuildCost = bvh->m_Cost;
+		return bvh;
+	}
+
+	std::shared_ptr<const SphereBVH> SphereBVH::buildAndReorder(std::vector<Sphere>& spheres) {
+		std::shared_ptr<const SphereBVH> built = build(spheres);
+
+		std::vector<Sphere> reordered;
+		reordered.reserve(spheres.size());
+		for (const unsigned int index : *built->m_Indices) {
+			reordered.push_back(spheres[index]);
+		}
+		spheres = std::move(reordered);
+
+		auto bvh = std::make_shared<SphereBVH>(*built);
+		auto indices = std::make_shared<std::vector<unsigned int>>(spheres.size());
+		std::iota(indices->begin(), indices->end(), 0u);
+		bvh->m_Indices = std::move(indices);
+		return bvh;
+	}
+
+	std::shared_ptr<const SphereBVH> SphereBVH::fromNodes(std::vector<Node> nodes, const unsigned int sphereCount) {
+		auto bvh = std::make_shared<SphereBVH>();
+		bvh->m_Nodes = std::move(nodes);
+
+		auto indices = std::make_shared<std::vector<unsigned int>>(sphereCount);
+		std::iota(indices->begin(), indices->end(), 0u);
+		bvh->m_Indices = std::move(indices);
+
+		if (!bvh->m_Nodes.empty()) {
+			float totalCost = 0.0f;
+			for (const Node& node : bvh->m_Nodes) {
+				totalCost += nodeCost(node);
+			}
+			bvh->m_Cost = relativeCost(bvh->m_Nodes, totalCost);
+		}
+		bvh->m_BuildCost = bvh->m_Cost;
+		return bvh;
+	}
+
+	std::shared_ptr<const SphereBVH> SphereBVH::refit(const SphereBVH& previous, const std::vector<Sphere>& spheres, ThreadPool& pool) {
+		auto bvh = std::make_shared<SphereBVH>();
+		bvh->m_Nodes = previous.m_Nodes;
+		bvh->m_Indices = previous.m_Indices;
+		bvh->m_BuildCost = previous.m_BuildCost;
+
+		std::vector<Node>& nodes = bvh->m_Nodes;
+		if (nodes.empty()) {
+			return bvh;
+		}
+
+		// Split the tree into subtrees for the workers by opening the largest subtree until there are enough.
+		// The nodes opened on the way are refit afterwards, parents after children.
+		struct Subtree {
+			unsigned int first;
+			unsigned int last;
+		};
+		std::vector<Subtree> subtrees{ Subtree{ 0, static_cast<unsigned int>(nodes.size()) } };
+		std::vector<unsigned int> opened;
+
+		const size_t wantedSubtrees = static_cast<size_t>(pool.getThreadCount()) * 4;
+		const unsigned int minimumSubtreeSize = 1024;
+		while (subtrees.size() < wantedSubtrees) {
+			const auto largest = std::max_element(subtrees.begin(), subtrees.end(), [](const Subtree& a, const Subtree& b) {
+				return a.last - a.first < b.last - b.first;
+			});
+
+			const Subtree subtree = *largest;
+			if (subtree.last - subtree.first < minimumSubtreeSize || nodes[subtree.first].count != 0) {
+				break;
+			}
+
+			opened.push_back(subtree.first);
+			*largest = Subtree{ subtree.first + 1, nodes[subtree.first].rightOrFirst };
+			subtrees.emplace_back(Subtree{ nodes[subtree.first].rightOrFirst, subtree.last });
+		}
+
+		std::vector<float> subtreeCosts(subtrees.size(), 0.0f);
+		{
+			TaskGroup group{};
+			for (size_t i = 0; i < subtrees.size(); i++) {
+				group.run(pool, [&, i]() {
+					subtreeCosts[i] = refitRange(nodes, *bvh->m_Indices, spheres, subtrees[i].first, subtrees[i].last);
+				});
+			}
+			group.wait();
+		}
+
+		// Opened nodes were recorded top down, so refitting them in reverse sees children first
+		float totalCost = std::accumulate(subtreeCosts.begin(), subtreeCosts.end(), 0.0f);
+		for (auto node = opened.rbegin(); node != opened.rend(); ++node) {
+			totalCost += refitRange(nodes, *bvh->m_Indices, spheres, *node, *node + 1);
+		}
+
+		bvh->m_Cost = relativeCost(nodes, totalCost);
+		return bvh;
+	}
+
+	unsigned int SphereBVH::closestHit(const Ray& ray, const std::vector<Sphere>& spheres, float& distance) const {
+		if (m_Nodes.empty()) {
+			return noHit;
+		}
+
+		const Malachite::Vector3f inverseDirection{ 1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z };
+
+		// Distance along the ray to where it enters node, or infinity when it misses or enters beyond distance
+		const auto enterDistance = [&](const Node& node) {
+			const float x0 = (node.min.x - ray.origin.x) * inverseDirection.x;
+			const float x1 = (node.max.x - ray.origin.x) * inverseDirection.x;
+			const float y0 = (node.min.y - ray.origin.y) * inverseDirection.y;
+			const float y1 = (node.max.y - ray.origin.y) * inverseDirection.y;
+			const float z0 = (node.min.z - ray.origin.z) * inverseDirection.z;
+			const float z1 = (node.max.z - ray.origin.z) * inverseDirection.z;
+
+			const float enter = std::max({ std::min(x0, x1), std::min(y0, y1), std::min(z0, z1), 0.0f });
+			const float exit = std::min({ std::max(x0, x1), std::max(y0, y1), std::max(z0, z1), distance });
+			return enter <= exit ? enter : std::numeric_limits<float>::max();
+		};
+
+		unsigned int closest = noHit;
+		unsigned int stack[traversalStackSize];
+		unsigned int stackSize = 0;
+		unsigned int current = 0;
+
+		if (enterDistance(m_Nodes[0]) == std::numeric_limits<float>::max()) {
+			return noHit;
+		}
+
+		while (true) {
+			const Node& node = m_Nodes[current];
+			if (node.count != 0) {
+				for (unsigned int i = node.rightOrFirst; i < node.rightOrFirst + node.count; i++) {
+					const unsigned int sphere = (*m_Indices)[i];
+					const float hitDistance = ray.hitSphere(spheres[sphere]);
+					if (hitDistance > 0.0f && hitDistance < distance) {
+						distance = hitDistance;
+						closest = sphere;
+					}
+				}
+			}
+			else {
+				// Visit the nearer child first so the far one can often be skipped
+				unsigned int nearChild = current + 1;
+				unsigned int farChild = node.rightOrFirst;
+				float nearDistance = enterDistance(m_Nodes[nearChild]);
+				float farDistance = enterDistance(m_Nodes[farChild]);
+				if (farDistance < nearDistance) {
+					std::swap(nearChild, farChild);
+					std::swap(nearDistance, farDistance);
+				}
+
+				if (nearDistance != std::numeric_limits<float>::max()) {
+					if (farDistance != std::numeric_limits<float>::max()) {
+						stack[stackSize++] = farChild;
+					}
+					current = nearChild;
+					continue;
+				}
+			}
+
+			// Pop until a node that can still hold something closer than the current hit
+			bool found = false;
+			while (stackSize > 0) {
+				current = stack[--stackSize];
+				if (enterDistance(m_Nodes[current]) != std::numeric_limits<float>::max()) {
+					found = true;
+					break;
+				}
+			}
+			if (!found) {
+				return closest;
+			}
+		}
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "Ray.h"
+#include "Sphere.h"
+#include "Threading/ThreadPool.h"
+#include "Vector.h"
+
+namespace Rhodochrosite {
+	// Bounding volume hierarchy over a scene's spheres, laid out depth first so every subtree is a contiguous
+	// range of nodes. Spheres are referenced by index and never reordered, so moved spheres only need a refit.
+	class SphereBVH {
+	public:
+		static constexpr unsigned int noHit = std::numeric_limits<unsigned int>::max();
+
+		struct Node {
+			Malachite::Vector3f min{ 0.0f };
+			unsigned int rightOrFirst{ 0 }; // Right child of an internal node (the left child follows it), first index of a leaf
+			Malachite::Vector3f max{ 0.0f };
+			unsigned int count{ 0 };        // Spheres in a leaf, 0 for internal nodes
+		};
+
+		[[nodiscard]] static std::shared_ptr<const SphereBVH> build(const std::vector<Sphere>& spheres);
+
+		// Also moves spheres into the order the leaves reference them, so refits read them front to back
+		[[nodiscard]] static std::shared_ptr<const SphereBVH> buildAndReorder(std::vector<Sphere>& spheres);
+
+		// The nodes of a buildAndReorder kept elsewhere, over sphereCount spheres already in leaf order
+		[[nodiscard]] static std::shared_ptr<const SphereBVH> fromNodes(std::vector<Node> nodes, unsigned int sphereCount);
+
+		// Same topology as previous with every bound recomputed bottom up for the spheres' new positions and radii,
+		// in parallel on pool. spheres must have as many spheres as previous was built with.
+		[[nodiscard]] static std::shared_ptr<const SphereBVH> refit(const SphereBVH& previous, const std::vector<Sphere>& spheres, ThreadPool& pool);
+
+		// Index of the closest sphere hit nearer than distance, which is updated, or noHit
+		[[nodiscard]] unsigned int closestHit(const Ray& ray, const std::vector<Sphere>& spheres, float& distance) const;
+
+		// Surface area heuristic cost relative to the root, it grows as refits stretch nodes over spheres that moved apart
+		[[nodiscard]] float getCost() const { return m_Cost; }
+		[[nodiscard]] float getBuildCost() const { return m_BuildCost; }
+
+		[[nodiscard]] unsigned int getSphereCount() const { return static_cast<unsigned int>(m_Indices->size()); }
+		[[nodiscard]] size_t getBytes() const { return m_Nodes.size() * sizeof(Node) + m_Indices->size() * sizeof(unsigned int); } // Nodes and sphere indices
+		[[nodiscard]] const std::vector<Node>& getNodes() const { return m_Nodes; }
+		[[nodiscard]] const std::vector<unsigned int>& getIndices() const { return *m_Indices; }
+
+	private:
+		std::vector<Node> m_Nodes;
+		std::shared_ptr<const std::vector<unsigned int>> m_Indices; // Shared by every refit of a build
+		float m_BuildCost{ 0.0f };
+		float m_Cost{ 0.0f };
+	};
+}
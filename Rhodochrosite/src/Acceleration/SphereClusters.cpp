@@ -0,0 +1,141 @@
+#include "SphereClusters.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace Rhodochrosite {
+	namespace {
+		constexpr unsigned int materialCount = 3;
+		constexpr float pi = 3.14159265358979f;
+
+		// Sums over a node's spheres, every sphere weighted by its cross section
+		struct ClusterSums {
+			float area{ 0.0f };
+			float largestArea{ 0.0f };
+			Malachite::Vector3f origin{ 0.0f };
+			Malachite::Vector3f colour{ 0.0f };
+			std::array<float, materialCount> materialArea{};
+
+			void add(const Sphere& sphere) {
+				const float sphereArea = pi * sphere.radius * sphere.radius;
+				area += sphereArea;
+				largestArea = std::max(largestArea, sphereArea);
+				origin += sphere.origin * sphereArea;
+				colour += sphere.colour.toVec3() * sphereArea;
+				materialArea[static_cast<unsigned int>(sphere.material)] += sphereArea;
+			}
+
+			void add(const ClusterSums& other) {
+				area += other.area;
+				largestArea = std::max(largestArea, other.largestArea);
+				origin += other.origin;
+				colour += other.colour;
+				for (unsigned int i = 0; i < materialCount; i++) {
+					materialArea[i] += other.materialArea[i];
+				}
+			}
+		};
+
+		Sphere makeProxy(const ClusterSums& sum, const Malachite::Vector3f& min, const Malachite::Vector3f& max) {
+			if (sum.area <= 0.0f) {
+				return Sphere{ (min + max) * 0.5f, 0.0f, Ruby::Colour::black };
+			}
+
+			const float inverseArea = 1.0f / sum.area;
+			const auto material = static_cast<unsigned int>(std::max_element(sum.materialArea.begin(), sum.materialArea.end()) - sum.materialArea.begin());
+
+			// Spheres scattered through the box shadow each other, so of the box's mean projected area, a quarter of its
+			// surface, they cover 1 - e^-(their cross section / that area). Never less than the largest sphere covers alone.
+			const Malachite::Vector3f extent = max - min;
+			const float boxArea = 0.5f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+			const float covered = boxArea > 0.0f ? boxArea * (1.0f - std::exp(-sum.area / boxArea)) : 0.0f;
+			const float radius = std::sqrt(std::max(covered, sum.largestArea) / pi);
+			return Sphere{ sum.origin * inverseArea, radius, Ruby::Colour{ sum.colour * inverseArea, 1.0f }, static_cast<Material>(material) };
+		}
+
+		// Proxies of the children of nodes first to last, every internal child's node must already be summed
+		void buildRange(const WideSphereBVH& bvh, const std::vector<Sphere>& spheres, std::vector<ClusterSums>& sums, std::vector<Sphere>& proxies, const unsigned int first, const unsigned int last) {
+			const std::vector<WideSphereBVH::Node>& nodes = bvh.getNodes();
+			const std::vector<unsigned int>& indices = bvh.getIndices();
+
+			for (unsigned int i = first; i < last; i++) {
+				const WideSphereBVH::Node& node = nodes[i];
+				const float step[3]{ std::ldexp(1.0f, node.exponent[0]), std::ldexp(1.0f, node.exponent[1]), std::ldexp(1.0f, node.exponent[2]) };
+
+				ClusterSums& nodeSum = sums[i];
+				unsigned int sphere = node.sphereBase;
+				for (unsigned int slot = 0; slot < node.childCount; slot++) {
+					ClusterSums childSum{};
+					if (node.leafSize[slot] == 0) {
+						childSum = sums[node.childBase + slot];
+					}
+					else {
+						for (unsigned int j = sphere; j < sphere + node.leafSize[slot]; j++) {
+							childSum.add(spheres[indices[j]]);
+						}
+						sphere += node.leafSize[slot];
+					}
+					nodeSum.add(childSum);
+
+					const Malachite::Vector3f min{
+						node.origin[0] + static_cast<float>(node.minX[slot]) * step[0],
+						node.origin[1] + static_cast<float>(node.minY[slot]) * step[1],
+						node.origin[2] + static_cast<float>(node.minZ[slot]) * step[2]
+					};
+					const Malachite::Vector3f max{
+						node.origin[0] + static_cast<float>(node.maxX[slot]) * step[0],
+						node.origin[1] + static_cast<float>(node.maxY[slot]) * step[1],
+						node.origin[2] + static_cast<float>(node.maxZ[slot]) * step[2]
+					};
+					proxies[static_cast<size_t>(i) * 8 + slot] = makeProxy(childSum, min, max);
+				}
+			}
+		}
+	}
+
+	std::shared_ptr<const SphereClusters> SphereClusters::build(std::shared_ptr<const WideSphereBVH> bvh, const std::vector<Sphere>& spheres, ThreadPool& pool) {
+		auto clusters = std::make_shared<SphereClusters>();
+		clusters->m_BVH = std::move(bvh);
+		const std::vector<WideSphereBVH::Node>& nodes = clusters->m_BVH->getNodes();
+		clusters->m_Proxies.resize(nodes.size() * 8);
+		std::vector<ClusterSums> sums(nodes.size());
+		if (nodes.empty()) {
+			return clusters;
+		}
+
+		// Nodes are laid out breadth first, so every level of the tree is a contiguous range of nodes after its parents' level
+		std::vector<unsigned int> levelStarts{ 0, 1 };
+		while (levelStarts.back() < nodes.size()) {
+			unsigned int next = levelStarts.back();
+			for (unsigned int i = levelStarts[levelStarts.size() - 2]; i < levelStarts.back(); i++) {
+				const WideSphereBVH::Node& node = nodes[i];
+				const auto internalChildren = static_cast<unsigned int>(std::count(node.leafSize, node.leafSize + node.childCount, std::uint8_t{ 0 }));
+				next = std::max(next, node.childBase + internalChildren);
+			}
+			levelStarts.push_back(next);
+		}
+
+		// Deepest level first, so a node's children are summed before it is
+		const unsigned int minimumChunkSize = 256;
+		const unsigned int chunkCount = pool.getThreadCount() * 4;
+		for (size_t level = levelStarts.size() - 1; level-- > 0;) {
+			const unsigned int first = levelStarts[level];
+			const unsigned int last = levelStarts[level + 1];
+			if (last - first < minimumChunkSize * 2) {
+				buildRange(*clusters->m_BVH, spheres, sums, clusters->m_Proxies, first, last);
+				continue;
+			}
+
+			const unsigned int chunkSize = std::max((last - first + chunkCount - 1) / chunkCount, minimumChunkSize);
+			TaskGroup group{};
+			for (unsigned int chunk = first; chunk < last; chunk += chunkSize) {
+				group.run(pool, [&, chunk]() {
+					buildRange(*clusters->m_BVH, spheres, sums, clusters->m_Proxies, chunk, std::min(chunk + chunkSize, last));
+				});
+			}
+			group.wait();
+		}
+		return clusters;
+	}
+}
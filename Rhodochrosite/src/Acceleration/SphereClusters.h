@@ -0,0 +1,26 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "WideSphereBVH.h"
+
+namespace Rhodochrosite {
+	// A proxy sphere for every child of a WideSphereBVH's nodes, standing in for all of the child's spheres once they are
+	// too far away to tell apart. A proxy covers as much of the child's box as the spheres do on average, taking their
+	// overlap into account, and has their area weighted centre and colour and the material covering most of their area.
+	class SphereClusters {
+	public:
+		// Built a level of the tree at a time, each level's nodes split across pool
+		[[nodiscard]] static std::shared_ptr<const SphereClusters> build(std::shared_ptr<const WideSphereBVH> bvh, const std::vector<Sphere>& spheres, ThreadPool& pool);
+
+		[[nodiscard]] const std::shared_ptr<const WideSphereBVH>& getBVH() const { return m_BVH; }
+
+		// Child slot of node at node * 8 + slot, what WideSphereBVH::closestHit takes as proxies
+		[[nodiscard]] const std::vector<Sphere>& getProxies() const { return m_Proxies; }
+
+	private:
+		std::shared_ptr<const WideSphereBVH> m_BVH;
+		std::vector<Sphere> m_Proxies;
+	};
+}
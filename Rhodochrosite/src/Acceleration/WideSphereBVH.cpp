@@ -0,0 +1,336 @@
+#include "WideSphereBVH.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define RHODOCHROSITE_SSE2
+#endif
+
+namespace Rhodochrosite {
+	namespace {
+		// Room for a depth of 72 with seven children pushed on every level
+		constexpr unsigned int traversalStackSize = 8 * 72;
+
+		float area(const SphereBVH::Node& node) {
+			const Malachite::Vector3f extent = node.max - node.min;
+			return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+		}
+
+		// Smallest power of two step that fits extent into 255 steps
+		std::int8_t stepExponent(const float extent) {
+			if (extent <= 0.0f) {
+				return -126;
+			}
+			const int exponent = static_cast<int>(std::ceil(std::log2(extent * 1.0001f / 255.0f)));
+			return static_cast<std::int8_t>(std::clamp(exponent, -126, 127));
+		}
+
+		std::uint8_t quantizeDown(const float value, const float origin, const float inverseStep) {
+			return static_cast<std::uint8_t>(std::clamp(std::floor((value - origin) * inverseStep), 0.0f, 255.0f));
+		}
+
+		std::uint8_t quantizeUp(const float value, const float origin, const float inverseStep) {
+			return static_cast<std::uint8_t>(std::clamp(std::ceil((value - origin) * inverseStep), 0.0f, 255.0f));
+		}
+
+		struct StackEntry {
+			unsigned int index;  // Node, first leaf slot sphere, or child slot of a proxy
+			unsigned int count;  // Spheres in a leaf, 0 for a node, proxyCount for a proxy
+			float enterDistance;
+		};
+
+		constexpr unsigned int proxyCount = std::numeric_limits<unsigned int>::max();
+	}
+
+	void WideSphereBVH::quantize(Node& node, const SphereBVH& binary, const std::array<unsigned int, 8>& sources) {
+		const std::vector<SphereBVH::Node>& binaryNodes = binary.getNodes();
+
+		Malachite::Vector3f min{ std::numeric_limits<float>::max() };
+		Malachite::Vector3f max{ -std::numeric_limits<float>::max() };
+		for (unsigned int i = 0; i < node.childCount; i++) {
+			const SphereBVH::Node& child = binaryNodes[sources[i]];
+			min = Malachite::Vector3f{ std::min(min.x, child.min.x), std::min(min.y, child.min.y), std::min(min.z, child.min.z) };
+			max = Malachite::Vector3f{ std::max(max.x, child.max.x), std::max(max.y, child.max.y), std::max(max.z, child.max.z) };
+		}
+
+		node.origin[0] = min.x;
+		node.origin[1] = min.y;
+		node.origin[2] = min.z;
+		node.exponent[0] = stepExponent(max.x - min.x);
+		node.exponent[1] = stepExponent(max.y - min.y);
+		node.exponent[2] = stepExponent(max.z - min.z);
+
+		const float inverseStep[3]{ std::ldexp(1.0f, -node.exponent[0]), std::ldexp(1.0f, -node.exponent[1]), std::ldexp(1.0f, -node.exponent[2]) };
+		for (unsigned int i = 0; i < 8; i++) {
+			if (i >= node.childCount) {
+				// Empty slots get an inverted box that no ray can enter
+				node.minX[i] = node.minY[i] = node.minZ[i] = 255;
+				node.maxX[i] = node.maxY[i] = node.maxZ[i] = 0;
+				continue;
+			}
+
+			const SphereBVH::Node& child = binaryNodes[sources[i]];
+			node.minX[i] = quantizeDown(child.min.x, min.x, inverseStep[0]);
+			node.minY[i] = quantizeDown(child.min.y, min.y, inverseStep[1]);
+			node.minZ[i] = quantizeDown(child.min.z, min.z, inverseStep[2]);
+			node.maxX[i] = quantizeUp(child.max.x, min.x, inverseStep[0]);
+			node.maxY[i] = quantizeUp(child.max.y, min.y, inverseStep[1]);
+			node.maxZ[i] = quantizeUp(child.max.z, min.z, inverseStep[2]);
+		}
+	}
+
+	std::shared_ptr<const WideSphereBVH> WideSphereBVH::collapse(const SphereBVH& binary) {
+		auto wide = std::make_shared<WideSphereBVH>();
+		auto topology = std::make_shared<Topology>();
+
+		const std::vector<SphereBVH::Node>& binaryNodes = binary.getNodes();
+		if (binaryNodes.empty()) {
+			wide->m_Topology = std::move(topology);
+			return wide;
+		}
+
+		// Nodes are laid out breadth first so every node's internal children are next to each other
+		std::deque<std::pair<unsigned int, unsigned int>> pending{ { 0u, 0u } }; // Wide node, binary node
+		wide->m_Nodes.emplace_back();
+		topology->sources.emplace_back();
+
+		while (!pending.empty()) {
+			const auto [wideIndex, binaryIndex] = pending.front();
+			pending.pop_front();
+
+			// Open the internal child with the largest surface area until there are eight children
+			std::vector<unsigned int> children;
+			if (binaryNodes[binaryIndex].count != 0) {
+				children.push_back(binaryIndex);
+			}
+			else {
+				children = { binaryIndex + 1, binaryNodes[binaryIndex].rightOrFirst };
+			}
+
+			while (children.size() < 8) {
+				auto largest = children.end();
+				for (auto child = children.begin(); child != children.end(); ++child) {
+					if (binaryNodes[*child].count == 0 && (largest == children.end() || area(binaryNodes[*child]) > area(binaryNodes[*largest]))) {
+						largest = child;
+					}
+				}
+				if (largest == children.end()) {
+					break;
+				}
+
+				const unsigned int opened = *largest;
+				*largest = opened + 1;
+				children.push_back(binaryNodes[opened].rightOrFirst);
+			}
+
+			std::stable_partition(children.begin(), children.end(), [&](const unsigned int child) { return binaryNodes[child].count == 0; });
+
+			Node node{};
+			node.childCount = static_cast<std::uint8_t>(children.size());
+			node.childBase = static_cast<std::uint32_t>(wide->m_Nodes.size());
+			node.sphereBase = static_cast<std::uint32_t>(topology->indices.size());
+
+			std::array<unsigned int, 8> sources{};
+			for (unsigned int slot = 0; slot < children.size(); slot++) {
+				const SphereBVH::Node& child = binaryNodes[children[slot]];
+				sources[slot] = children[slot];
+
+				if (child.count == 0) {
+					pending.emplace_back(static_cast<unsigned int>(wide->m_Nodes.size()), children[slot]);
+					wide->m_Nodes.emplace_back();
+					topology->sources.emplace_back();
+					node.leafSize[slot] = 0;
+				}
+				else {
+					const std::vector<unsigned int>& binaryIndices = binary.getIndices();
+					topology->indices.insert(topology->indices.end(), binaryIndices.begin() + child.rightOrFirst, binaryIndices.begin() + child.rightOrFirst + child.count);
+					node.leafSize[slot] = static_cast<std::uint8_t>(child.count);
+				}
+			}
+
+			quantize(node, binary, sources);
+			wide->m_Nodes[wideIndex] = node;
+			topology->sources[wideIndex] = sources;
+		}
+
+		wide->m_Topology = std::move(topology);
+		return wide;
+	}
+
+	std::shared_ptr<const WideSphereBVH> WideSphereBVH::refit(const WideSphereBVH& previous, const SphereBVH& binary, ThreadPool& pool) {
+		auto wide = std::make_shared<WideSphereBVH>();
+		wide->m_Nodes = previous.m_Nodes;
+		wide->m_Topology = previous.m_Topology;
+
+		// Every node only reads the binary tree's bounds, so the nodes are split into as many ranges as SphereBVH::refit
+		// splits its tree into, with the same minimum size
+		const auto nodeCount = static_cast<unsigned int>(wide->m_Nodes.size());
+		const unsigned int minimumRangeSize = 1024;
+		const unsigned int rangeSize = std::max((nodeCount + pool.getThreadCount() * 4 - 1) / (pool.getThreadCount() * 4), minimumRangeSize);
+
+		TaskGroup group{};
+		for (unsigned int first = 0; first < nodeCount; first += rangeSize) {
+			group.run(pool, [&, first]() {
+				for (unsigned int i = first; i < std::min(first + rangeSize, nodeCount); i++) {
+					quantize(wide->m_Nodes[i], binary, wide->m_Topology->sources[i]);
+				}
+			});
+		}
+		group.wait();
+		return wide;
+	}
+
+	size_t WideSphereBVH::getBytes() const {
+		return m_Nodes.size() * sizeof(Node) + m_Topology->sources.size() * sizeof(std::array<unsigned int, 8>) + m_Topology->indices.size() * sizeof(unsigned int);
+	}
+
+	float WideSphereBVH::getBytesPerSphere() const {
+		const size_t sphereCount = m_Topology->indices.size();
+		return sphereCount == 0 ? 0.0f : static_cast<float>(getBytes()) / static_cast<float>(sphereCount);
+	}
+
+	unsigned int WideSphereBVH::closestHit(const Ray& ray, const std::vector<Sphere>& spheres, float& distance) const {
+		const Sphere* closest = traverse<false>(ray, spheres, nullptr, 0.0f, distance);
+		return closest == nullptr ? SphereBVH::noHit : static_cast<unsigned int>(closest - spheres.data());
+	}
+
+	const Sphere* WideSphereBVH::closestHit(const Ray& ray, const std::vector<Sphere>& spheres, const std::vector<Sphere>& proxies, const float maxSolidAngle, float& distance) const {
+		// A ray starting inside a child's box always descends into it
+		return traverse<true>(ray, spheres, &proxies, std::min(maxSolidAngle, 1.0f), distance);
+	}
+
+	template<bool UseProxies>
+	const Sphere* WideSphereBVH::traverse(const Ray& ray, const std::vector<Sphere>& spheres, const std::vector<Sphere>* proxies, const float maxSolidAngle, float& distance) const {
+		if (m_Nodes.empty()) {
+			return nullptr;
+		}
+
+		const float inverseDirection[3]{ 1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z };
+		const float rayOrigin[3]{ ray.origin.x, ray.origin.y, ray.origin.z };
+		const std::vector<unsigned int>& indices = m_Topology->indices;
+
+		const Sphere* closest = nullptr;
+		StackEntry stack[traversalStackSize];
+		unsigned int stackSize = 0;
+		stack[stackSize++] = StackEntry{ 0, 0, 0.0f };
+
+		while (stackSize > 0) {
+			const StackEntry entry = stack[--stackSize];
+			if (entry.enterDistance >= distance) {
+				continue;
+			}
+
+			if constexpr (UseProxies) {
+				if (entry.count == proxyCount) {
+					const Sphere& proxy = (*proxies)[entry.index];
+					const float hitDistance = ray.hitSphere(proxy);
+					if (hitDistance > 0.0f && hitDistance < distance) {
+						distance = hitDistance;
+						closest = &proxy;
+					}
+					continue;
+				}
+			}
+
+			if (entry.count != 0) {
+				for (unsigned int i = entry.index; i < entry.index + entry.count; i++) {
+					const float hitDistance = ray.hitSphere(spheres[indices[i]]);
+					if (hitDistance > 0.0f && hitDistance < distance) {
+						distance = hitDistance;
+						closest = &spheres[indices[i]];
+					}
+				}
+				continue;
+			}
+
+			const Node& node = m_Nodes[entry.index];
+
+			// Along each axis a child's slab is entered at offset + quantized * scale
+			float step[3];
+			float offset[3];
+			float scale[3];
+			for (int axis = 0; axis < 3; axis++) {
+				step[axis] = std::ldexp(1.0f, node.exponent[axis]);
+				offset[axis] = (node.origin[axis] - rayOrigin[axis]) * inverseDirection[axis];
+				scale[axis] = step[axis] * inverseDirection[axis];
+			}
+
+			float enter[8];
+			bool hit[8];
+#ifdef RHODOCHROSITE_SSE2
+			const auto loadBytes = [](const std::uint8_t* bytes) {
+				int packed;
+				std::memcpy(&packed, bytes, sizeof(packed));
+				const __m128i zero = _mm_setzero_si128();
+				const __m128i words = _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero);
+				return _mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero));
+			};
+
+			for (unsigned int half = 0; half < 8; half += 4) {
+				const __m128 x0 = _mm_add_ps(_mm_set1_ps(offset[0]), _mm_mul_ps(loadBytes(node.minX + half), _mm_set1_ps(scale[0])));
+				const __m128 x1 = _mm_add_ps(_mm_set1_ps(offset[0]), _mm_mul_ps(loadBytes(node.maxX + half), _mm_set1_ps(scale[0])));
+				const __m128 y0 = _mm_add_ps(_mm_set1_ps(offset[1]), _mm_mul_ps(loadBytes(node.minY + half), _mm_set1_ps(scale[1])));
+				const __m128 y1 = _mm_add_ps(_mm_set1_ps(offset[1]), _mm_mul_ps(loadBytes(node.maxY + half), _mm_set1_ps(scale[1])));
+				const __m128 z0 = _mm_add_ps(_mm_set1_ps(offset[2]), _mm_mul_ps(loadBytes(node.minZ + half), _mm_set1_ps(scale[2])));
+				const __m128 z1 = _mm_add_ps(_mm_set1_ps(offset[2]), _mm_mul_ps(loadBytes(node.maxZ + half), _mm_set1_ps(scale[2])));
+
+				const __m128 enterDistance = _mm_max_ps(_mm_max_ps(_mm_min_ps(x0, x1), _mm_min_ps(y0, y1)), _mm_max_ps(_mm_min_ps(z0, z1), _mm_setzero_ps()));
+				const __m128 exitDistance = _mm_min_ps(_mm_min_ps(_mm_max_ps(x0, x1), _mm_max_ps(y0, y1)), _mm_min_ps(_mm_max_ps(z0, z1), _mm_set1_ps(distance)));
+				const int mask = _mm_movemask_ps(_mm_cmple_ps(enterDistance, exitDistance));
+
+				_mm_storeu_ps(enter + half, enterDistance);
+				for (unsigned int i = 0; i < 4; i++) {
+					hit[half + i] = (mask >> i) & 1;
+				}
+			}
+#else
+			for (unsigned int i = 0; i < 8; i++) {
+				const float x0 = offset[0] + node.minX[i] * scale[0], x1 = offset[0] + node.maxX[i] * scale[0];
+				const float y0 = offset[1] + node.minY[i] * scale[1], y1 = offset[1] + node.maxY[i] * scale[1];
+				const float z0 = offset[2] + node.minZ[i] * scale[2], z1 = offset[2] + node.maxZ[i] * scale[2];
+
+				enter[i] = std::max({ std::min(x0, x1), std::min(y0, y1), std::min(z0, z1), 0.0f });
+				const float exit = std::min({ std::max(x0, x1), std::max(y0, y1), std::max(z0, z1), distance });
+				hit[i] = enter[i] <= exit;
+			}
+#endif
+
+			// Push the children that were hit farthest first, so the nearest is visited next
+			StackEntry* first = stack + stackSize;
+			unsigned int sphere = node.sphereBase;
+			for (unsigned int slot = 0; slot < node.childCount; slot++) {
+				const unsigned int leafSize = node.leafSize[slot];
+				if (hit[slot]) {
+					StackEntry child = leafSize == 0 ? StackEntry{ node.childBase + slot, 0, enter[slot] } : StackEntry{ sphere, leafSize, enter[slot] };
+
+					// Children far enough away are only ever hit as their proxy
+					if constexpr (UseProxies) {
+						const Malachite::Vector3f extent{
+							static_cast<float>(node.maxX[slot] - node.minX[slot]) * step[0],
+							static_cast<float>(node.maxY[slot] - node.minY[slot]) * step[1],
+							static_cast<float>(node.maxZ[slot] - node.minZ[slot]) * step[2]
+						};
+						if (extent.lengthSquared() * 0.25f < enter[slot] * enter[slot] * maxSolidAngle) {
+							child = StackEntry{ entry.index * 8 + slot, proxyCount, enter[slot] };
+						}
+					}
+
+					StackEntry* position = stack + stackSize++;
+					while (position != first && (position - 1)->enterDistance < child.enterDistance) {
+						*position = *(position - 1);
+						position--;
+					}
+					*position = child;
+				}
+				sphere += leafSize;
+			}
+		}
+
+		return closest;
+	}
+}
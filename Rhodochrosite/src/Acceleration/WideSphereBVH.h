@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "SphereBVH.h"
+
+namespace Rhodochrosite {
+	// Eight wide hierarchy collapsed from a SphereBVH, with child bounds quantized to a byte per axis relative to
+	// their parent's box. A node is 80 bytes for up to eight children, where the binary tree spends 32 bytes per
+	// child, and all eight children are tested against a ray at once.
+	class WideSphereBVH {
+	public:
+		struct Node {
+			float origin[3];            // Minimum corner of the box around every child
+			std::int8_t exponent[3];    // A quantization step is 2^exponent along each axis
+			std::uint8_t childCount;
+
+			std::uint32_t childBase;    // Internal children come first, child i is node childBase + i
+			std::uint32_t sphereBase;   // Spheres of the leaf children follow each other from here
+			std::uint8_t leafSize[8];   // 0 for internal children
+
+			std::uint8_t minX[8], minY[8], minZ[8];
+			std::uint8_t maxX[8], maxY[8], maxZ[8];
+		};
+
+		[[nodiscard]] static std::shared_ptr<const WideSphereBVH> collapse(const SphereBVH& binary);
+
+		// Requantizes previous' nodes from binary's bounds in parallel on pool, binary must be a refit of the tree previous
+		// was collapsed from
+		[[nodiscard]] static std::shared_ptr<const WideSphereBVH> refit(const WideSphereBVH& previous, const SphereBVH& binary, ThreadPool& pool);
+
+		[[nodiscard]] unsigned int closestHit(const Ray& ray, const std::vector<Sphere>& spheres, float& distance) const;
+
+		// Closest sphere or proxy hit, or nullptr. A child is hit as its proxy instead of being descended into when the
+		// sphere around its box covers less than maxSolidAngle, as (radius / distance)^2 from where the ray enters the box.
+		// proxies has a sphere for every child slot, slot of node at node * 8 + slot, as SphereClusters builds them.
+		[[nodiscard]] const Sphere* closestHit(const Ray& ray, const std::vector<Sphere>& spheres, const std::vector<Sphere>& proxies, float maxSolidAngle, float& distance) const;
+
+		// Breadth first, so every level of the tree is a contiguous range of nodes
+		[[nodiscard]] const std::vector<Node>& getNodes() const { return m_Nodes; }
+		// Sphere of every leaf slot, a node's leaf children take theirs in slot order from sphereBase
+		[[nodiscard]] const std::vector<unsigned int>& getIndices() const { return m_Topology->indices; }
+
+		// Nodes, sphere indices and the binary node behind every child that refits requantize from
+		[[nodiscard]] size_t getBytes() const;
+		[[nodiscard]] float getBytesPerSphere() const;
+
+	private:
+		std::vector<Node> m_Nodes;
+
+		// Shared by every refit of a collapse
+		struct Topology {
+			std::vector<unsigned int> indices;                    // Sphere of every leaf slot
+			std::vector<std::array<unsigned int, 8>> sources;     // Binary node behind every child
+		};
+		std::shared_ptr<const Topology> m_Topology;
+
+		static void quantize(Node& node, const SphereBVH& binary, const std::array<unsigned int, 8>& sources);
+
+		template<bool UseProxies>
+		[[nodiscard]] const Sphere* traverse(const Ray& ray, const std::vector<Sphere>& spheres, const std::vector<Sphere>* proxies, float maxSolidAngle, float& distance) const;
+	};
+}
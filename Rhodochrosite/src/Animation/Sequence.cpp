@@ -0,0 +1,106 @@
+#include "Sequence.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Rhodochrosite {
+	namespace {
+		// Finds the pair of keyframes surrounding time and how far between them time is
+		template<typename Keyframe>
+		void surroundingKeyframes(const std::vector<Keyframe>& keyframes, const float time, const Keyframe*& from, const Keyframe*& to, float& t) {
+			const auto next = std::upper_bound(keyframes.begin(), keyframes.end(), time, [](const float value, const Keyframe& keyframe) {
+				return value < keyframe.time;
+			});
+
+			if (next == keyframes.begin()) {
+				from = to = &keyframes.front();
+				t = 0.0f;
+				return;
+			}
+
+			if (next == keyframes.end()) {
+				from = to = &keyframes.back();
+				t = 0.0f;
+				return;
+			}
+
+			from = &*(next - 1);
+			to = &*next;
+			const float span = to->time - from->time;
+			t = span > 0.0f ? (time - from->time) / span : 0.0f;
+		}
+
+		Malachite::Vector3f lerp(const Malachite::Vector3f& a, const Malachite::Vector3f& b, const float t) {
+			return a + (b - a) * t;
+		}
+
+		// Turns a towards b at a constant rate along the shortest arc
+		Malachite::Vector3f slerpDirection(const Malachite::Vector3f& a, const Malachite::Vector3f& b, const float t) {
+			const Malachite::Vector3f from = a.normalize();
+			const Malachite::Vector3f to = b.normalize();
+			const float cosAngle = std::clamp(dot(from, to), -1.0f, 1.0f);
+
+			// Direction in the plane of the arc at right angles to from. Opposite directions have no single arc,
+			// they turn through the horizontal, or through the world's forward axis when they point straight up or down.
+			Malachite::Vector3f perpendicular = to - from * cosAngle;
+			if (perpendicular.lengthSquared() < 1e-8f) {
+				if (cosAngle > 0.0f) {
+					return from;
+				}
+				perpendicular = cross(from, Malachite::Vector3f::up);
+				if (perpendicular.lengthSquared() < 1e-8f) {
+					perpendicular = cross(from, Malachite::Vector3f{ 0.0f, 0.0f, -1.0f });
+				}
+			}
+			perpendicular = perpendicular.normalize();
+
+			const float angle = std::acos(cosAngle) * t;
+			return from * std::cos(angle) + perpendicular * std::sin(angle);
+		}
+	}
+
+	float Sequence::frameTime(const unsigned int frame) const {
+		return static_cast<float>(frame) / framesPerSecond;
+	}
+
+	CameraKeyframe Sequence::cameraAt(const float time) const {
+		if (cameraPath.empty()) {
+			return CameraKeyframe{ time };
+		}
+
+		const CameraKeyframe* from{ nullptr };
+		const CameraKeyframe* to{ nullptr };
+		float t{ 0.0f };
+		surroundingKeyframes(cameraPath, time, from, to, t);
+
+		CameraKeyframe keyframe{};
+		keyframe.time = time;
+		keyframe.position = lerp(from->position, to->position, t);
+		keyframe.direction = slerpDirection(from->direction, to->direction, t);
+		return keyframe;
+	}
+
+	SceneSnapshot Sequence::sceneAt(const float time) const {
+		if (sphereTracks.empty()) {
+			// Static scene, every frame shares the same snapshot
+			return scene;
+		}
+
+		return editSnapshot(scene, [&](Scene& frameScene) {
+			for (const SphereTrack& track : sphereTracks) {
+				if (track.keyframes.empty() || track.sphereIndex >= frameScene.spheres.size()) {
+					continue;
+				}
+
+				const SphereKeyframe* from{ nullptr };
+				const SphereKeyframe* to{ nullptr };
+				float t{ 0.0f };
+				surroundingKeyframes(track.keyframes, time, from, to, t);
+
+				Sphere& sphere = frameScene.spheres[track.sphereIndex];
+				sphere.origin = lerp(from->origin, to->origin, t);
+				sphere.radius = from->radius + (to->radius - from->radius) * t;
+			}
+		});
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+
+#include "Scene.h"
+#include "Vector.h"
+
+namespace Rhodochrosite {
+	struct CameraKeyframe {
+		float time{ 0.0f };
+		Malachite::Vector3f position{ 0.0f };
+		Malachite::Vector3f direction{ 0.0f, 0.0f, -1.0f };
+	};
+
+	struct SphereKeyframe {
+		float time{ 0.0f };
+		Malachite::Vector3f origin{ 0.0f };
+		float radius{ 0.0f };
+	};
+
+	// Animates Scene::spheres[sphereIndex], keyframes must be sorted by time
+	struct SphereTrack {
+		unsigned int sphereIndex{ 0 };
+		std::vector<SphereKeyframe> keyframes;
+	};
+
+	struct Sequence {
+		SceneSnapshot scene;
+		std::vector<CameraKeyframe> cameraPath; // Sorted by time
+		std::vector<SphereTrack> sphereTracks;
+
+		unsigned int frameCount{ 0 };
+		float framesPerSecond{ 24.0f };
+
+		[[nodiscard]] float frameTime(unsigned int frame) const;
+		[[nodiscard]] CameraKeyframe cameraAt(float time) const;
+		[[nodiscard]] SceneSnapshot sceneAt(float time) const;
+	};
+}
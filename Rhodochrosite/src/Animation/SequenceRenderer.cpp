@@ -0,0 +1,100 @@
+#include "SequenceRenderer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "Output/PPM.h"
+#include "Threading/BlockingQueue.h"
+
+namespace Rhodochrosite {
+	namespace {
+		struct Frame {
+			unsigned int index{ 0 };
+			std::vector<unsigned char> data;
+		};
+
+		// Two frames per stage keeps every thread busy while bounding memory use
+		constexpr size_t framesInFlight = 2;
+
+		double secondsSince(const std::chrono::steady_clock::time_point start) {
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+	}
+
+	SequenceRenderer::SequenceRenderer(SequenceSettings settings)
+		: m_Settings(std::move(settings))
+		, m_Renderer(m_Settings.width, m_Settings.height, m_Camera) {
+		m_Renderer.setAlgorithm(m_Settings.algorithm);
+		m_Renderer.setTemporalReprojection(m_Settings.temporalReprojection);
+	}
+
+	std::filesystem::path SequenceRenderer::framePath(const unsigned int frame) const {
+		char name[32];
+		std::snprintf(name, sizeof(name), "frame_%05u.ppm", frame);
+		return m_Settings.outputDirectory / name;
+	}
+
+	SequenceStats SequenceRenderer::render(const Sequence& sequence) {
+		const auto sequenceStart = std::chrono::steady_clock::now();
+
+		SequenceStats stats{};
+		m_FramesCompleted = 0;
+
+		std::error_code error{};
+		std::filesystem::create_directories(m_Settings.outputDirectory, error);
+
+		BlockingQueue<Frame> encodeQueue{ framesInFlight };
+		BlockingQueue<Frame> writeQueue{ framesInFlight };
+		std::atomic<unsigned int> framesFailed{ 0 };
+
+		std::thread encoder{ [&]() {
+			while (std::optional<Frame> frame = encodeQueue.pop()) {
+				frame->data = encodePPM(frame->data, m_Settings.width, m_Settings.height);
+				writeQueue.push(std::move(*frame));
+			}
+			writeQueue.close();
+		} };
+
+		std::thread writer{ [&]() {
+			while (std::optional<Frame> frame = writeQueue.pop()) {
+				if (!writeFileAtomically(framePath(frame->index), frame->data)) {
+					++framesFailed;
+				}
+				++m_FramesCompleted;
+			}
+		} };
+
+		for (unsigned int i = m_Settings.firstFrame; i < sequence.frameCount; i++) {
+			if (m_Settings.resume && std::filesystem::exists(framePath(i), error)) {
+				stats.framesSkipped++;
+				++m_FramesCompleted;
+				continue;
+			}
+
+			const float time = sequence.frameTime(i);
+			const CameraKeyframe cameraState = sequence.cameraAt(time);
+			m_Camera.position = cameraState.position;
+			m_Camera.front = cameraState.direction;
+			m_Camera.updateCameraVectors();
+
+			m_Renderer.setScene(sequence.sceneAt(time));
+
+			const auto renderStart = std::chrono::steady_clock::now();
+			m_Renderer.render();
+			stats.renderSeconds += secondsSince(renderStart);
+
+			encodeQueue.push(Frame{ i, m_Renderer.getImage().getContent() });
+			stats.framesRendered++;
+		}
+
+		encodeQueue.close();
+		encoder.join();
+		writer.join();
+
+		stats.framesFailed = framesFailed;
+		stats.totalSeconds = secondsSince(sequenceStart);
+		return stats;
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+
+#include "Camera.h"
+#include "Rendering/Renderer.h"
+#include "Sequence.h"
+
+namespace Rhodochrosite {
+	struct SequenceSettings {
+		unsigned int width{ 640 };
+		unsigned int height{ 360 };
+		std::filesystem::path outputDirectory{ "Sequence" };
+
+		unsigned int firstFrame{ 0 };
+		bool resume{ true }; // Skip frames already present in outputDirectory
+
+		Renderer::PerPixelAlgorithm algorithm{ &Renderer::basicLightingAlgorithm };
+
+		// Reuse the previous frame's samples along the camera path, frames of an animated scene are shaded in full anyway
+		bool temporalReprojection{ false };
+	};
+
+	struct SequenceStats {
+		unsigned int framesRendered{ 0 };
+		unsigned int framesSkipped{ 0 };
+		unsigned int framesFailed{ 0 };
+
+		double renderSeconds{ 0.0 }; // Time spent inside Renderer::render
+		double totalSeconds{ 0.0 };
+	};
+
+	// Renders every frame of a Sequence to disk. Frame i + 1 is rendered while frame i
+	// is encoded and written on two other threads, so the total time approaches the render time.
+	class SequenceRenderer {
+	public:
+		explicit SequenceRenderer(SequenceSettings settings);
+
+		SequenceStats render(const Sequence& sequence);
+
+		[[nodiscard]] unsigned int getFramesCompleted() const { return m_FramesCompleted; }
+		[[nodiscard]] std::filesystem::path framePath(unsigned int frame) const;
+
+	private:
+		SequenceSettings m_Settings;
+		Ruby::Camera m_Camera{};
+		Renderer m_Renderer;
+
+		std::atomic<unsigned int> m_FramesCompleted{ 0 };
+	};
+}
@@ -0,0 +1,106 @@
+#include "DynamicScene.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace Rhodochrosite {
+	DynamicScene::DynamicScene(Scene scene, ThreadPool& pool)
+		: m_Scene(std::move(scene))
+		, m_Pool(pool) {
+		m_Scene.sphereBVH = nullptr;
+		m_BVH = SphereBVH::buildAndReorder(m_Scene.spheres);
+		m_WideBVH = WideSphereBVH::collapse(*m_BVH);
+
+		// Lights do not move, their tree is built once and shared by every snapshot
+		if (m_Scene.lightTree == nullptr && !(m_Scene.pointLights.empty() && m_Scene.sphereLights.empty())) {
+			m_Scene.lightTree = LightTree::build(m_Scene.pointLights, m_Scene.sphereLights);
+		}
+	}
+
+	DynamicScene::~DynamicScene() {
+		if (m_Rebuild.valid()) {
+			m_Rebuild.wait();
+		}
+	}
+
+	SceneSnapshot DynamicScene::publish() {
+		const auto start = std::chrono::steady_clock::now();
+
+		// A finished rebuild has the right topology for spheres that were where they are a few frames ago,
+		// refitting it brings it up to date
+		std::shared_ptr<const SphereBVH> previous = m_BVH;
+		bool rebuilt = false;
+		if (m_Rebuild.valid() && m_Rebuild.wait_for(std::chrono::seconds{ 0 }) == std::future_status::ready) {
+			previous = m_Rebuild.get();
+			rebuilt = true;
+			m_Stats.rebuilds++;
+		}
+		m_BVH = SphereBVH::refit(*previous, m_Scene.spheres, m_Pool);
+
+		// The wide hierarchy only needs collapsing again when the binary one has a new topology
+		m_WideBVH = rebuilt ? WideSphereBVH::collapse(*m_BVH) : WideSphereBVH::refit(*m_WideBVH, *m_BVH, m_Pool);
+
+		m_Stats.refitMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		m_Stats.cost = m_BVH->getBuildCost() > 0.0f ? m_BVH->getCost() / m_BVH->getBuildCost() : 1.0f;
+		m_Stats.bytesPerSphere = m_Scene.spheres.empty() ? 0.0f : static_cast<float>(m_BVH->getBytes() + m_WideBVH->getBytes()) / static_cast<float>(m_Scene.spheres.size());
+
+		// The snapshot takes the edited spheres, everything else in the scene is small enough to copy
+		std::vector<Sphere> spheres = takeReleasedBuffer();
+		spheres.swap(m_Scene.spheres);
+		m_Scene.spheres.resize(spheres.size());
+		copySpheres(spheres, m_Scene.spheres);
+
+		auto published = std::make_unique<Scene>();
+		published->spheres = std::move(spheres);
+		published->planes = m_Scene.planes;
+		published->discs = m_Scene.discs;
+		published->lights = m_Scene.lights;
+		published->pointLights = m_Scene.pointLights;
+		published->sphereLights = m_Scene.sphereLights;
+		published->lightTree = m_Scene.lightTree;
+		published->sphereBVH = m_BVH;
+		published->wideSphereBVH = m_WideBVH;
+		m_Published = SceneSnapshot{ published.release(), [buffers = m_SphereBuffers](Scene* scene) {
+			{
+				std::lock_guard<std::mutex> lock{ buffers->mutex };
+				if (buffers->released.size() < 2) {
+					buffers->released.emplace_back(std::move(scene->spheres));
+				}
+			}
+			delete scene;
+		} };
+
+		if (!m_Rebuild.valid() && m_Stats.cost > m_RebuildThreshold) {
+			// Built from the published snapshot, which can never change underneath the rebuild
+			m_Rebuild = std::async(std::launch::async, [snapshot = m_Published]() {
+				return SphereBVH::build(snapshot->spheres);
+			});
+		}
+		m_Stats.rebuilding = m_Rebuild.valid();
+		m_Stats.publishMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		return m_Published;
+	}
+
+	std::vector<Sphere> DynamicScene::takeReleasedBuffer() {
+		std::lock_guard<std::mutex> lock{ m_SphereBuffers->mutex };
+		if (m_SphereBuffers->released.empty()) {
+			return {};
+		}
+		std::vector<Sphere> buffer = std::move(m_SphereBuffers->released.back());
+		m_SphereBuffers->released.pop_back();
+		return buffer;
+	}
+
+	void DynamicScene::copySpheres(const std::vector<Sphere>& from, std::vector<Sphere>& to) {
+		// Chunks large enough that a task is never just overhead
+		const size_t chunkSize = std::max<size_t>(from.size() / (static_cast<size_t>(m_Pool.getThreadCount()) * 4) + 1, 16384);
+		TaskGroup group{};
+		for (size_t first = 0; first < from.size(); first += chunkSize) {
+			group.run(m_Pool, [&, first]() {
+				std::copy_n(from.begin() + first, std::min(chunkSize, from.size() - first), to.begin() + first);
+			});
+		}
+		group.wait();
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <future>
+#include <memory>
+#include <mutex>
+
+#include "Scene.h"
+#include "Threading/ThreadPool.h"
+
+namespace Rhodochrosite {
+	struct DynamicSceneStats {
+		float refitMilliseconds{ 0.0f };   // Last publish, both hierarchies
+		float publishMilliseconds{ 0.0f }; // Last publish, everything including the snapshot's copy of the spheres
+		float cost{ 0.0f };              // Of the published hierarchy, relative to a fresh build of it
+		float bytesPerSphere{ 0.0f };    // Of both hierarchies, with their indices and what refits need
+		unsigned int rebuilds{ 0 };      // Rebuilds swapped in so far
+		bool rebuilding{ false };
+	};
+
+	// Scene whose spheres move every frame. Each publish refits the sphere hierarchy in parallel instead of
+	// rebuilding it. When refits have stretched it too far a rebuild starts in the background, and the rebuilt
+	// hierarchy is refit to the latest spheres and swapped in by the first publish after it finishes.
+	class DynamicScene {
+	public:
+		explicit DynamicScene(Scene scene, ThreadPool& pool = ThreadPool::shared());
+		~DynamicScene();
+
+		DynamicScene(const DynamicScene& other) = delete;
+		DynamicScene& operator=(const DynamicScene& other) = delete;
+
+		// Spheres can be moved, resized and recoloured between publishes, but not added or removed. They are kept
+		// in spatial order rather than the order the scene was given in, so refits stream through memory.
+		[[nodiscard]] std::vector<Sphere>& getSpheres() { return m_Scene.spheres; }
+
+		// The published snapshot takes the edited spheres, and they are copied back on the pool into the sphere
+		// buffer of an earlier snapshot nobody holds any more rather than a new allocation
+		[[nodiscard]] SceneSnapshot publish();
+
+		// Rebuild once the cost of the refit hierarchy is this many times the cost it was built with
+		void setRebuildThreshold(const float threshold) { m_RebuildThreshold = threshold; }
+		[[nodiscard]] const DynamicSceneStats& getStats() const { return m_Stats; }
+
+	private:
+		Scene m_Scene;
+		std::shared_ptr<const SphereBVH> m_BVH;
+		std::shared_ptr<const WideSphereBVH> m_WideBVH;
+		SceneSnapshot m_Published;
+
+		// Filled by the deleter of every published snapshot, which can outlive the scene
+		struct SphereBuffers {
+			std::mutex mutex;
+			std::vector<std::vector<Sphere>> released;
+		};
+		std::shared_ptr<SphereBuffers> m_SphereBuffers{ std::make_shared<SphereBuffers>() };
+
+		ThreadPool& m_Pool;
+		std::future<std::shared_ptr<const SphereBVH>> m_Rebuild;
+		float m_RebuildThreshold{ 1.5f };
+
+		DynamicSceneStats m_Stats;
+
+		[[nodiscard]] std::vector<Sphere> takeReleasedBuffer();
+		void copySpheres(const std::vector<Sphere>& from, std::vector<Sphere>& to);
+	};
+}
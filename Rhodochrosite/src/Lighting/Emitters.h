@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Vector.h"
+
+namespace Rhodochrosite {
+	struct PointLight {
+		Malachite::Vector3f position{ 0.0f };
+		Malachite::Vector3f colour{ 1.0f };
+		float intensity{ 1.0f };
+	};
+
+	struct SphereLight {
+		Malachite::Vector3f position{ 0.0f };
+		float radius{ 0.1f };
+		Malachite::Vector3f colour{ 1.0f };
+		float intensity{ 1.0f };
+	};
+
+	// Point and sphere lights as the light tree sees them, a point light has a radius of 0
+	struct Emitter {
+		Malachite::Vector3f position{ 0.0f };
+		float radius{ 0.0f };
+		Malachite::Vector3f radiantIntensity{ 0.0f }; // colour * intensity
+		float power{ 0.0f };
+
+		// Light arriving at position on a surface facing normal, without visibility
+		[[nodiscard]] Malachite::Vector3f irradiance(const Malachite::Vector3f& surfacePosition, const Malachite::Vector3f& normal) const;
+	};
+}
@@ -0,0 +1,173 @@
+#include "LightTree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace Rhodochrosite {
+	namespace {
+		float luminance(const Malachite::Vector3f& colour) {
+			return 0.2126f * colour.x + 0.7152f * colour.y + 0.0722f * colour.z;
+		}
+
+		float component(const Malachite::Vector3f& vector, const int axis) {
+			return axis == 0 ? vector.x : (axis == 1 ? vector.y : vector.z);
+		}
+	}
+
+	Malachite::Vector3f Emitter::irradiance(const Malachite::Vector3f& surfacePosition, const Malachite::Vector3f& normal) const {
+		const Malachite::Vector3f toLight = position - surfacePosition;
+		const float distanceSquared = Malachite::max(toLight.lengthSquared(), radius * radius + 1e-4f);
+		const float cosine = Malachite::max(dot(normal, toLight.normalize()), 0.0f);
+
+		return radiantIntensity * (cosine / distanceSquared);
+	}
+
+	std::shared_ptr<const LightTree> LightTree::build(const std::vector<PointLight>& pointLights, const std::vector<SphereLight>& sphereLights) {
+		auto tree = std::make_shared<LightTree>();
+
+		for (const PointLight& light : pointLights) {
+			const Malachite::Vector3f radiantIntensity = light.colour * light.intensity;
+			tree->m_Emitters.emplace_back(Emitter{ light.position, 0.0f, radiantIntensity, luminance(radiantIntensity) });
+		}
+		for (const SphereLight& light : sphereLights) {
+			const Malachite::Vector3f radiantIntensity = light.colour * light.intensity;
+			tree->m_Emitters.emplace_back(Emitter{ light.position, light.radius, radiantIntensity, luminance(radiantIntensity) });
+		}
+
+		if (tree->m_Emitters.empty()) {
+			return tree;
+		}
+
+		std::vector<unsigned int> order(tree->m_Emitters.size());
+		std::iota(order.begin(), order.end(), 0u);
+
+		tree->m_Nodes.reserve(order.size() * 2);
+		tree->m_Leaves.resize(order.size());
+		tree->buildNode(order, 0, order.size(), 0);
+		return tree;
+	}
+
+	unsigned int LightTree::buildNode(std::vector<unsigned int>& emitters, const size_t first, const size_t last, const unsigned int parent) {
+		const auto index = static_cast<unsigned int>(m_Nodes.size());
+		m_Nodes.emplace_back();
+
+		Node node{};
+		node.parent = parent;
+		node.min = Malachite::Vector3f{ std::numeric_limits<float>::max() };
+		node.max = Malachite::Vector3f{ -std::numeric_limits<float>::max() };
+
+		Malachite::Vector3f centroidMin{ std::numeric_limits<float>::max() };
+		Malachite::Vector3f centroidMax{ -std::numeric_limits<float>::max() };
+		for (size_t i = first; i < last; i++) {
+			const Emitter& emitter = m_Emitters[emitters[i]];
+			node.min = Malachite::Vector3f{ std::min(node.min.x, emitter.position.x - emitter.radius), std::min(node.min.y, emitter.position.y - emitter.radius), std::min(node.min.z, emitter.position.z - emitter.radius) };
+			node.max = Malachite::Vector3f{ std::max(node.max.x, emitter.position.x + emitter.radius), std::max(node.max.y, emitter.position.y + emitter.radius), std::max(node.max.z, emitter.position.z + emitter.radius) };
+			centroidMin = Malachite::Vector3f{ std::min(centroidMin.x, emitter.position.x), std::min(centroidMin.y, emitter.position.y), std::min(centroidMin.z, emitter.position.z) };
+			centroidMax = Malachite::Vector3f{ std::max(centroidMax.x, emitter.position.x), std::max(centroidMax.y, emitter.position.y), std::max(centroidMax.z, emitter.position.z) };
+			node.power += emitter.power;
+		}
+
+		if (last - first == 1) {
+			node.leaf = true;
+			node.emitter = emitters[first];
+			m_Leaves[node.emitter] = index;
+			m_Nodes[index] = node;
+			return index;
+		}
+
+		// Median split along the longest axis of the light positions
+		const Malachite::Vector3f extent = centroidMax - centroidMin;
+		int axis = 0;
+		if (extent.y > component(extent, axis)) { axis = 1; }
+		if (extent.z > component(extent, axis)) { axis = 2; }
+
+		const size_t middle = first + (last - first) / 2;
+		std::nth_element(emitters.begin() + first, emitters.begin() + middle, emitters.begin() + last, [&](const unsigned int a, const unsigned int b) {
+			return component(m_Emitters[a].position, axis) < component(m_Emitters[b].position, axis);
+		});
+
+		node.left = buildNode(emitters, first, middle, index);
+		node.right = buildNode(emitters, middle, last, index);
+		m_Nodes[index] = node;
+		return index;
+	}
+
+	float LightTree::importance(const Node& node, const Malachite::Vector3f& position, const Malachite::Vector3f& normal) const {
+		const Malachite::Vector3f centre = (node.min + node.max) * 0.5f;
+		const float radiusSquared = (node.max - centre).lengthSquared();
+
+		const Malachite::Vector3f toCentre = centre - position;
+		const float distanceSquared = toCentre.lengthSquared();
+		if (distanceSquared <= radiusSquared) {
+			// Inside the bounds, any direction is possible and the distance cannot be bounded away from 0
+			return node.power / Malachite::max(radiusSquared, 1e-4f);
+		}
+
+		// Smallest angle between the normal and any direction into the node's bounding sphere
+		const float distance = std::sqrt(distanceSquared);
+		const float cosineToCentre = Malachite::clamp(dot(normal, toCentre) / distance, -1.0f, 1.0f);
+		const float boundingAngle = std::asin(std::sqrt(radiusSquared) / distance);
+		const float angle = Malachite::max(std::acos(cosineToCentre) - boundingAngle, 0.0f);
+		const float cosineBound = std::cos(angle);
+		if (cosineBound <= 0.0f) {
+			return 0.0f;
+		}
+
+		return node.power * cosineBound / Malachite::max(distanceSquared - radiusSquared, radiusSquared + 1e-4f);
+	}
+
+	bool LightTree::sample(const Malachite::Vector3f& position, const Malachite::Vector3f& normal, float u, Sample& sample) const {
+		if (m_Nodes.empty()) {
+			return false;
+		}
+
+		float probability = 1.0f;
+		unsigned int current = 0;
+		while (!m_Nodes[current].leaf) {
+			const Node& node = m_Nodes[current];
+			const float left = importance(m_Nodes[node.left], position, normal);
+			const float right = importance(m_Nodes[node.right], position, normal);
+			if (left + right <= 0.0f) {
+				return false;
+			}
+
+			const float leftProbability = left / (left + right);
+			if (u < leftProbability) {
+				u = u / leftProbability;
+				probability *= leftProbability;
+				current = node.left;
+			}
+			else {
+				u = (u - leftProbability) / (1.0f - leftProbability);
+				probability *= 1.0f - leftProbability;
+				current = node.right;
+			}
+
+			// Keep u in [0, 1) after rescaling
+			u = Malachite::min(u, 0.99999994f);
+		}
+
+		sample.emitter = m_Nodes[current].emitter;
+		sample.probability = probability;
+		return true;
+	}
+
+	float LightTree::probability(const Malachite::Vector3f& position, const Malachite::Vector3f& normal, const unsigned int emitter) const {
+		float probability = 1.0f;
+		unsigned int current = m_Leaves[emitter];
+		while (current != 0) {
+			const Node& parent = m_Nodes[m_Nodes[current].parent];
+			const float left = importance(m_Nodes[parent.left], position, normal);
+			const float right = importance(m_Nodes[parent.right], position, normal);
+			if (left + right <= 0.0f) {
+				return 0.0f;
+			}
+
+			probability *= (parent.left == current ? left : right) / (left + right);
+			current = m_Nodes[current].parent;
+		}
+
+		return probability;
+	}
+}
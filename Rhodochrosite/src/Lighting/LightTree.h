@@ -0,0 +1,52 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Emitters.h"
+#include "Vector.h"
+
+namespace Rhodochrosite {
+	// Bounding volume hierarchy over a scene's point and sphere lights. Picking a light walks from the root,
+	// choosing each child with probability proportional to its estimated importance at the shading point,
+	// so a pick costs O(log n) and the probability of every pick is known.
+	class LightTree {
+	public:
+		struct Sample {
+			unsigned int emitter{ 0 };
+			float probability{ 0.0f };
+		};
+
+		[[nodiscard]] static std::shared_ptr<const LightTree> build(const std::vector<PointLight>& pointLights, const std::vector<SphereLight>& sphereLights);
+
+		// u is a uniform random number in [0, 1). Returns false when no light can reach the shading point.
+		[[nodiscard]] bool sample(const Malachite::Vector3f& position, const Malachite::Vector3f& normal, float u, Sample& sample) const;
+
+		// Probability that sample picks emitter, used to check or weight a pick made some other way
+		[[nodiscard]] float probability(const Malachite::Vector3f& position, const Malachite::Vector3f& normal, unsigned int emitter) const;
+
+		[[nodiscard]] const Emitter& getEmitter(const unsigned int emitter) const { return m_Emitters[emitter]; }
+		[[nodiscard]] unsigned int getEmitterCount() const { return static_cast<unsigned int>(m_Emitters.size()); }
+
+	private:
+		struct Node {
+			Malachite::Vector3f min{ 0.0f };
+			Malachite::Vector3f max{ 0.0f };
+			float power{ 0.0f };
+
+			// Leaves hold one emitter, internal nodes always have two children
+			unsigned int left{ 0 };
+			unsigned int right{ 0 };
+			unsigned int emitter{ 0 };
+			unsigned int parent{ 0 };
+			bool leaf{ false };
+		};
+
+		std::vector<Emitter> m_Emitters;
+		std::vector<Node> m_Nodes;
+		std::vector<unsigned int> m_Leaves; // Leaf node of every emitter
+
+		unsigned int buildNode(std::vector<unsigned int>& emitters, size_t first, size_t last, unsigned int parent);
+		[[nodiscard]] float importance(const Node& node, const Malachite::Vector3f& position, const Malachite::Vector3f& normal) const;
+	};
+}
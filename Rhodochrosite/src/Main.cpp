@@ -1,3 +1,5 @@
+#include <GL/glew.h>
+
 #include "Camera.h"
 #include "Window.h"
 #include "Timing.h"
@@ -13,6 +15,22 @@
 
 #include "Rendering/Materials/RayTracingMaterial.h"
 
+#include "Animation/SequenceRenderer.h"
+#include "OutOfCore/BrickBuilder.h"
+#include "OutOfCore/OutOfCoreRenderer.h"
+#include "Random.h"
+#include "Rendering/Autotune.h"
+#include "Replay/SessionRecording.h"
+#include "Replay/SessionReplayer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <optional>
+
 auto scene = Rhodochrosite::SceneName::ONE_SPHERE;
 auto device = Rhodochrosite::RenderingDevice::CPU;
 auto algorithm = Rhodochrosite::RenderingAlgorithm::BASIC_LIGHTING;
@@ -34,6 +52,19 @@ std::unique_ptr<Rhodochrosite::Renderer> rayTracer{ nullptr };
 
 Rhodochrosite::Scenes sceneCollection;
 
+// Sequence rendering
+std::unique_ptr<Rhodochrosite::SequenceRenderer> sequenceRenderer{ nullptr };
+std::future<Rhodochrosite::SequenceStats> sequenceJob;
+Rhodochrosite::SequenceStats lastSequenceStats{};
+unsigned int sequenceFrameCount{ 0 };
+void startFlyThrough();
+
+// Session recording, enabled with --record <file>
+std::unique_ptr<Rhodochrosite::SessionRecorder> sessionRecorder{ nullptr };
+int replaySession(const char* path, Rhodochrosite::ReplayPacing pacing, const char* reportPath, const Rhodochrosite::TuningConfig& tuning);
+int renderOutOfCore(const char* directory, unsigned int frames);
+int brickSphereCloud(unsigned long long count, const char* directory);
+
 // Camera stuff
 Ruby::Camera camera{};
 struct FPSController {
@@ -48,6 +79,12 @@ struct FPSController {
 FPSController fpsController{ };
 bool cursorNormal = false;
 
+// The CPU renderer only follows the camera while it can reproject its last frame, each move would start from scratch otherwise
+bool cameraMoved = false;
+bool cameraControllable() {
+	return device == Rhodochrosite::RenderingDevice::GPU || (rayTracer != nullptr && rayTracer->getTemporalReprojection());
+}
+
 void mousePositionCallback(int xpos, int ypos, void* data) {
 	FPSController* controller = (FPSController*)data;
 
@@ -65,7 +102,7 @@ void mousePositionCallback(int xpos, int ypos, void* data) {
 	xOffset *= controller->mouseSensitivity;
 	yOffset *= controller->mouseSensitivity;
 
-	if (controller->mouse != nullptr && controller->mouse->button2 && device == Rhodochrosite::RenderingDevice::GPU) {
+	if (controller->mouse != nullptr && controller->mouse->button2 && cameraControllable()) {
 		controller->yaw += xOffset;
 		controller->pitch += yOffset;
 
@@ -81,6 +118,7 @@ void mousePositionCallback(int xpos, int ypos, void* data) {
 
 		camera.front = direction.normalize();
 		camera.updateCameraVectors();
+		cameraMoved = true;
 	}
 }
 
@@ -98,7 +136,114 @@ extern "C" {
 
 bool sceneRendered = false;
 
-int main() {
+// Uploads just the finished parts of the CPU render instead of the whole image
+void uploadCompletedTiles(Ruby::Texture& texture, Rhodochrosite::Renderer& tracer) {
+	static std::vector<Rhodochrosite::Tile> tiles{};
+	tiles.clear();
+	tracer.takeCompletedTiles(tiles);
+	if (tiles.empty()) {
+		return;
+	}
+
+	Ruby::Image& image = tracer.getImage();
+	const unsigned char* content = image.getContent().data();
+
+	texture.bind();
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint)image.getWidth());
+	for (const Rhodochrosite::Tile& tile : tiles) {
+		const unsigned char* firstPixel = content + ((size_t)tile.x + (size_t)tile.y * image.getWidth()) * 4;
+		glTexSubImage2D(GL_TEXTURE_2D, 0, (GLint)tile.x, (GLint)tile.y, (GLsizei)tile.width, (GLsizei)tile.height, GL_RGBA, GL_UNSIGNED_BYTE, firstPixel);
+	}
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	tracer.releaseCompletedTiles();
+}
+
+int main(int argc, char** argv) {
+	const char* recordPath{ nullptr };
+	const char* replayPath{ nullptr };
+	const char* reportPath{ "replay_report.csv" };
+	auto pacing = Rhodochrosite::ReplayPacing::AS_FAST_AS_POSSIBLE;
+	const char* tuningCachePath{ "autotune.cache" };
+	bool forceAutotune{ false };
+	std::optional<unsigned int> tileSizeOverride{};
+	std::optional<unsigned int> threadCountOverride{};
+	std::optional<Rhodochrosite::SphereTraversal> traversalOverride{};
+	const char* outOfCorePath{ nullptr };
+	unsigned int outOfCoreFrames{ 60 };
+	const char* brickPath{ nullptr };
+	unsigned long long brickSphereCount{ 0 };
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+			recordPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+			replayPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--report") == 0 && i + 1 < argc) {
+			reportPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--paced") == 0) {
+			pacing = Rhodochrosite::ReplayPacing::RECORDED;
+		}
+		else if (std::strcmp(argv[i], "--autotune") == 0) {
+			forceAutotune = true;
+		}
+		else if (std::strcmp(argv[i], "--tuning-cache") == 0 && i + 1 < argc) {
+			tuningCachePath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--tile-size") == 0 && i + 1 < argc) {
+			tileSizeOverride = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			threadCountOverride = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--traversal") == 0 && i + 1 < argc) {
+			traversalOverride = std::strcmp(argv[++i], "binary") == 0 ? Rhodochrosite::SphereTraversal::BINARY_BVH : Rhodochrosite::SphereTraversal::WIDE_BVH;
+		}
+		else if (std::strcmp(argv[i], "--out-of-core") == 0 && i + 1 < argc) {
+			outOfCorePath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+			outOfCoreFrames = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--brick-cloud") == 0 && i + 2 < argc) {
+			brickSphereCount = std::strtoull(argv[++i], nullptr, 10);
+			brickPath = argv[++i];
+		}
+	}
+
+	if (brickPath != nullptr) {
+		const int result = brickSphereCloud(brickSphereCount, brickPath);
+		if (result != 0 || outOfCorePath == nullptr) {
+			return result;
+		}
+	}
+
+	// Tuning is looked up for this machine and only measured when it has none, or when asked to
+	const Rhodochrosite::MachineKey machine = Rhodochrosite::MachineKey::current();
+	std::optional<Rhodochrosite::TuningConfig> tuning = forceAutotune ? std::nullopt : Rhodochrosite::loadTuning(tuningCachePath, machine);
+	if (!tuning) {
+		std::cout << "Autotuning for " << machine.cpuModel << " with " << machine.hardwareThreads << " threads\n";
+		tuning = Rhodochrosite::autotune(sceneCollection);
+		if (!Rhodochrosite::saveTuning(tuningCachePath, machine, *tuning)) {
+			std::cerr << "Could not write tuning cache " << tuningCachePath << "\n";
+		}
+	}
+	if (tileSizeOverride) { tuning->tileSize = *tileSizeOverride; }
+	if (threadCountOverride) { tuning->threadCount = *threadCountOverride; }
+	if (traversalOverride) { tuning->traversal = *traversalOverride; }
+	Rhodochrosite::ThreadPool::setSharedThreadCount(tuning->threadCount);
+
+	// Replays and out of core renders run headless, without ever opening a window
+	if (replayPath != nullptr) {
+		return replaySession(replayPath, pacing, reportPath, *tuning);
+	}
+	if (outOfCorePath != nullptr) {
+		return renderOutOfCore(outOfCorePath, outOfCoreFrames);
+	}
+
 	// Quad Rendering Setup
 	Wavellite::Window window{Wavellite::Window::WindowSize::HALF_SCREEN, "Rhodochrosite"};
 	window.setSwapInterval(0);
@@ -108,6 +253,10 @@ int main() {
 
 	mouse.addMousePositionCallback(mousePositionCallback, (void*)&fpsController);
 
+	if (recordPath != nullptr) {
+		sessionRecorder = std::make_unique<Rhodochrosite::SessionRecorder>(recordPath, window.getWidth(), window.getHeight());
+	}
+
 	Ruby::Camera cam{};
 	Ruby::Renderer renderer{ cam, window };
 	Wavellite::Time time{};
@@ -117,6 +266,7 @@ int main() {
 
 	// Ray tracing Setup
 	rayTracer = std::make_unique<Rhodochrosite::Renderer>( window.getWidth(), window.getHeight(), camera );
+	Rhodochrosite::applyTuning(*tuning, *rayTracer);
 
 	// Shader setup
 	basicLighting = std::make_unique<Ruby::ShaderProgram>(
@@ -212,11 +362,14 @@ int main() {
 			renderer.render(screenRenderable);
 			switch (device) {
 			case Rhodochrosite::RenderingDevice::CPU:
-				if (!sceneRendered) {
-					rayTracer->render();
-					renderTarget.updateData();
+				// A moved camera waits for the frame in flight, only complete frames are reprojected
+				if (!sceneRendered || (cameraMoved && rayTracer->isRenderComplete())) {
+					uploadCompletedTiles(renderTarget, *rayTracer);
+					rayTracer->beginRender();
 					sceneRendered = true;
+					cameraMoved = false;
 				}
+				uploadCompletedTiles(renderTarget, *rayTracer);
 				screenRenderable.setMaterial(screenQuadMaterial);
 
 				break;
@@ -236,9 +389,10 @@ int main() {
 		}
 
 		{ // Camera Movement
-			if (mouse.button2 && device == Rhodochrosite::RenderingDevice::GPU) {
+			if (mouse.button2 && cameraControllable()) {
 				window.disableCursor();
 				const float velocity = 5.0f * time.deltaTime;
+				cameraMoved = cameraMoved || keyboard.KEY_W || keyboard.KEY_S || keyboard.KEY_A || keyboard.KEY_D || keyboard.KEY_SPACE || keyboard.KEY_LEFT_SHIFT;
 				if (keyboard.KEY_W) { camera.position = camera.position + (velocity * camera.front); }
 				if (keyboard.KEY_S) { camera.position = camera.position + (velocity * -camera.front); }
 				if (keyboard.KEY_A) { camera.position = camera.position + (velocity * -camera.right); }
@@ -249,6 +403,10 @@ int main() {
 			else {
 				window.enableCursor();
 			}
+
+			if (sessionRecorder != nullptr) {
+				sessionRecorder->recordCamera(camera);
+			}
 		}
 
 		{ // Rendering
@@ -277,6 +435,9 @@ int main() {
 						case Rhodochrosite::SceneName::RANDOM_SPHERES:
 							status += "Currently rendering a random collection of spheres ";
 							break;
+						case Rhodochrosite::SceneName::MANY_LIGHTS:
+							status += "Currently rendering thousands of lights ";
+							break;
 						}
 
 						switch (device) {
@@ -306,14 +467,20 @@ int main() {
 					}
 					ImGui::Text(status.c_str());
 
+					if (const Rhodochrosite::SceneSnapshot cpuScene = rayTracer->getScene(); cpuScene != nullptr && cpuScene->wideSphereBVH != nullptr) {
+						ImGui::Text(("Sphere BVH: " + std::to_string(cpuScene->wideSphereBVH->getBytesPerSphere()) + " bytes per sphere").c_str());
+					}
+
 					ImGui::Text("Rendering Device:");
 					if (ImGui::Button("CPU Rendering")) {
 						device = Rhodochrosite::RenderingDevice::CPU;
+						if (sessionRecorder != nullptr) { sessionRecorder->recordDevice(device); }
 						sceneRendered = false;
 						setAlgorithm(Rhodochrosite::RenderingAlgorithm::BASIC_LIGHTING);
 					}
 					if (ImGui::Button("GPU Rendering")) {
 						device = Rhodochrosite::RenderingDevice::GPU;
+						if (sessionRecorder != nullptr) { sessionRecorder->recordDevice(device); }
 						sceneRendered = false;
 					}
 
@@ -335,33 +502,96 @@ int main() {
 						sceneRendered = false;
 					}
 
+					if (device == Rhodochrosite::RenderingDevice::CPU) {
+						ImGui::Text("Sampling:");
+						if (ImGui::Button("Random")) {
+							rayTracer->setSampler(std::make_shared<Rhodochrosite::RandomSampler>());
+							sceneRendered = false;
+						}
+						if (ImGui::Button("Sobol")) {
+							rayTracer->setSampler(std::make_shared<Rhodochrosite::SobolSampler>());
+							sceneRendered = false;
+						}
+						if (ImGui::Button("Blue Noise")) {
+							rayTracer->setSampler(std::make_shared<Rhodochrosite::BlueNoiseSampler>());
+							sceneRendered = false;
+						}
+						for (const unsigned int samplesPerPixel : { 1u, 4u, 16u }) {
+							if (ImGui::Button((std::to_string(samplesPerPixel) + " spp").c_str())) {
+								rayTracer->setSamplesPerPixel(samplesPerPixel);
+								sceneRendered = false;
+							}
+						}
+
+						if (ImGui::Button(rayTracer->getProgressivePreview() ? "Progressive Preview: On" : "Progressive Preview: Off")) {
+							rayTracer->setProgressivePreview(!rayTracer->getProgressivePreview());
+							sceneRendered = false;
+						}
+						if (rayTracer->getProgressivePreview()) {
+							ImGui::Text(("Preview passes done: " + std::to_string(rayTracer->getCompletedPasses()) + " / 4").c_str());
+						}
+
+						if (ImGui::Button(rayTracer->getTemporalReprojection() ? "Temporal Reprojection: On" : "Temporal Reprojection: Off")) {
+							rayTracer->setTemporalReprojection(!rayTracer->getTemporalReprojection());
+							sceneRendered = false;
+						}
+						if (rayTracer->getTemporalReprojection()) {
+							const Rhodochrosite::Renderer::TemporalStats temporalStats = rayTracer->getTemporalStats();
+							ImGui::Text(("Reprojected " + std::to_string(temporalStats.reprojectedPixels) + ", shaded " + std::to_string(temporalStats.shadedPixels)).c_str());
+						}
+
+						const bool geometricLOD = rayTracer->getGeometricLODThreshold() > 0.0f;
+						if (ImGui::Button(geometricLOD ? "Geometric LOD: On" : "Geometric LOD: Off")) {
+							rayTracer->setGeometricLOD(geometricLOD ? 0.0f : Rhodochrosite::Renderer::defaultLODThreshold);
+							sceneRendered = false;
+						}
+					}
+
 					ImGui::Text("Scene:");
 					if (ImGui::Button("One Sphere")) {
-						setAlgorithm(algorithm);
 						setScene(Rhodochrosite::SceneName::ONE_SPHERE);
 						sceneRendered = false;
 					}
 					if (ImGui::Button("Sphere On Plane")) {
-						setAlgorithm(algorithm);
 						setScene(Rhodochrosite::SceneName::SPHERE_ON_PLANE);
 						sceneRendered = false;
 					}
 					if (ImGui::Button("Two Spheres")) {
-						setAlgorithm(algorithm);
 						setScene(Rhodochrosite::SceneName::TWO_SPHERE);
 						sceneRendered = false;
 					}
 					if (ImGui::Button("Lots of Spheres")) {
-						setAlgorithm(algorithm);
 						setScene(Rhodochrosite::SceneName::LARGE_AMOUNT_OF_SPHERES);
 						sceneRendered = false;
 					}
 					if (ImGui::Button("Random Spheres")) {
-						setAlgorithm(algorithm);
 						sceneCollection.regenerateRandomSpheres();
 						setScene(Rhodochrosite::SceneName::RANDOM_SPHERES);
 						sceneRendered = false;
 					}
+					if (ImGui::Button("Many Lights")) {
+						setScene(Rhodochrosite::SceneName::MANY_LIGHTS);
+						sceneRendered = false;
+					}
+
+					ImGui::Text("Sequence:");
+					if (sequenceJob.valid()) {
+						if (sequenceJob.wait_for(std::chrono::seconds{ 0 }) == std::future_status::ready) {
+							lastSequenceStats = sequenceJob.get();
+						}
+						else {
+							ImGui::Text(("Rendering fly-through: " + std::to_string(sequenceRenderer->getFramesCompleted()) + " / " + std::to_string(sequenceFrameCount) + " frames").c_str());
+						}
+					}
+					else {
+						if (ImGui::Button("Render Fly-through")) {
+							startFlyThrough();
+						}
+						if (lastSequenceStats.framesRendered + lastSequenceStats.framesSkipped > 0) {
+							ImGui::Text(("Last fly-through: " + std::to_string(lastSequenceStats.framesRendered) + " frames in " + std::to_string(lastSequenceStats.totalSeconds) + " seconds, "
+								+ std::to_string(lastSequenceStats.renderSeconds) + " seconds rendering").c_str());
+						}
+					}
 
 					ImGui::Text("Frame Time: ");
 					ImGui::Text((std::to_string(time.deltaTime * 1000.0f) + "miliseconds").c_str());
@@ -378,6 +608,8 @@ int main() {
 		window.swapBuffers();
 		time.endFrame();
 	}
+
+	rayTracer->cancelRender();
 }
 
 void uploadSphere(const Rhodochrosite::Sphere& sphere, unsigned int index) {
@@ -404,86 +636,138 @@ void uploadSphere(const Rhodochrosite::Sphere& sphere, unsigned int index) {
 
 void setScene(const Rhodochrosite::SceneName newScene) {
 	scene = newScene;
-	switch (scene) {
-	case Rhodochrosite::SceneName::ONE_SPHERE:
-		// CPU side
-		rayTracer->setScene(sceneCollection.oneSphere);
-
-		// GPU side
-		Rhodochrosite::RayTracingMaterial::spheres = sceneCollection.oneSphere.spheres;
-		Rhodochrosite::RayTracingMaterial::dirLights = sceneCollection.oneSphere.lights;
-		break;
-	case Rhodochrosite::SceneName::SPHERE_ON_PLANE:
-		// CPU side
-		rayTracer->setScene(sceneCollection.sphereOnPlane);
-
-		// GPU side
-		Rhodochrosite::RayTracingMaterial::spheres = sceneCollection.sphereOnPlane.spheres;
-		Rhodochrosite::RayTracingMaterial::dirLights = sceneCollection.sphereOnPlane.lights;
-		break;
-	case Rhodochrosite::SceneName::TWO_SPHERE:
-		// CPU side
-		rayTracer->setScene(sceneCollection.twoSpheres);
-
-		// GPU side
-		Rhodochrosite::RayTracingMaterial::spheres = sceneCollection.twoSpheres.spheres;
-		Rhodochrosite::RayTracingMaterial::dirLights = sceneCollection.twoSpheres.lights;
-		break;
-	case Rhodochrosite::SceneName::LARGE_AMOUNT_OF_SPHERES:
-		// CPU side
-		rayTracer->setScene(sceneCollection.lotsOfSpheres);
-
-		// GPU side
-		Rhodochrosite::RayTracingMaterial::spheres = sceneCollection.lotsOfSpheres.spheres;
-		Rhodochrosite::RayTracingMaterial::dirLights = sceneCollection.lotsOfSpheres.lights;
-		break;
-	case Rhodochrosite::SceneName::RANDOM_SPHERES:
-		// CPU side
-		rayTracer->setScene(sceneCollection.randomSpheres);
 
-		// GPU side
-		Rhodochrosite::RayTracingMaterial::spheres = sceneCollection.randomSpheres.spheres;
-		Rhodochrosite::RayTracingMaterial::dirLights = sceneCollection.randomSpheres.lights;
-		break;
+	const Rhodochrosite::SceneSnapshot snapshot = sceneCollection.get(scene);
+	if (sessionRecorder != nullptr) {
+		sessionRecorder->recordScene(scene);
 	}
+
+	// Both sides share the same snapshot, switching scenes never copies sphere data
+	rayTracer->setScene(snapshot);
+	Rhodochrosite::RayTracingMaterial::scene = snapshot;
 }
 
 void setAlgorithm(Rhodochrosite::RenderingAlgorithm newAlgorithm) {
 	algorithm = newAlgorithm;
-	Ruby::Colour(Rhodochrosite::Renderer::* cpuAlg)(const Malachite::Vector2f & texCords) const;
-	std::string vertPath = "";
-	std::string fragPath = "";
+	if (sessionRecorder != nullptr) {
+		sessionRecorder->recordAlgorithm(algorithm);
+	}
 
+	// GPU side
 	switch (algorithm) {
 	case Rhodochrosite::RenderingAlgorithm::BASIC_LIGHTING:
-		// CPU side
-		cpuAlg = &Rhodochrosite::Renderer::basicLightingAlgorithm;
-
-		// GPU side
 		activeMaterial = basicLightingMaterial.get();
 		break;
 	case Rhodochrosite::RenderingAlgorithm::ALL_REFLECTIVE:
-		// CPU side
-		cpuAlg = &Rhodochrosite::Renderer::allReflectiveAlgorithm;
-
-		// GPU side
 		activeMaterial = allReflectiveMaterial.get();
 		break;
 	case Rhodochrosite::RenderingAlgorithm::ALL_DIFFUSE:
-		// CPU side
-		cpuAlg = &Rhodochrosite::Renderer::allDiffuseAlgorithm;
-
-		// GPU side
 		activeMaterial = allDiffuseMaterial.get();
 		break;
 	case Rhodochrosite::RenderingAlgorithm::RANDOM_MATERIALS:
-		// CPU side
-		cpuAlg = &Rhodochrosite::Renderer::randomMaterialsAlgorithm;
-
-		// GPU side
 		activeMaterial = randomMaterialsMaterial.get();
 		break;
 	}
-	rayTracer->setAlgorithm(cpuAlg);
-	setScene(scene);
-}
\ No newline at end of file
+
+	// CPU side
+	rayTracer->setAlgorithm(Rhodochrosite::Renderer::perPixelAlgorithm(algorithm));
+}
+
+void startFlyThrough() {
+	// Dolly in towards the scene while panning across it
+	Rhodochrosite::Sequence sequence{};
+	sequence.scene = rayTracer->getScene();
+	sequence.framesPerSecond = 24.0f;
+	sequence.frameCount = 120;
+	sequence.cameraPath.emplace_back(Rhodochrosite::CameraKeyframe{ 0.0f, Malachite::Vector3f{ -2.0f, 1.0f, 3.0f }, Malachite::Vector3f{ 0.4f, -0.2f, -1.0f }.normalize() });
+	sequence.cameraPath.emplace_back(Rhodochrosite::CameraKeyframe{ 2.5f, Malachite::Vector3f{ 0.0f, 0.5f, 1.0f }, Malachite::Vector3f{ 0.0f, -0.1f, -1.0f }.normalize() });
+	sequence.cameraPath.emplace_back(Rhodochrosite::CameraKeyframe{ 5.0f, Malachite::Vector3f{ 2.0f, 1.0f, 0.0f }, Malachite::Vector3f{ -0.4f, -0.2f, -1.0f }.normalize() });
+	sequenceFrameCount = sequence.frameCount;
+
+	Rhodochrosite::SequenceSettings settings{};
+	settings.width = rayTracer->getImage().getWidth();
+	settings.height = rayTracer->getImage().getHeight();
+	settings.outputDirectory = "FlyThrough";
+	settings.algorithm = &Rhodochrosite::Renderer::basicLightingAlgorithm;
+	settings.temporalReprojection = rayTracer->getTemporalReprojection();
+
+	sequenceRenderer = std::make_unique<Rhodochrosite::SequenceRenderer>(settings);
+	sequenceJob = std::async(std::launch::async, [sequence = std::move(sequence)]() {
+		return sequenceRenderer->render(sequence);
+	});
+}
+
+int replaySession(const char* path, const Rhodochrosite::ReplayPacing pacing, const char* reportPath, const Rhodochrosite::TuningConfig& tuning) {
+	const std::optional<Rhodochrosite::Session> session = Rhodochrosite::loadSession(path);
+	if (!session) {
+		std::cerr << "Could not read session " << path << "\n";
+		return 1;
+	}
+
+	Rhodochrosite::SessionReplayer replayer{ *session, sceneCollection, tuning };
+	const Rhodochrosite::ReplayReport report = replayer.replay(pacing);
+
+	std::cout << "Replayed " << session->events.size() << " events, " << report.framesRendered << " frames at "
+		<< session->width << "x" << session->height << " in " << report.totalSeconds << " seconds\n";
+
+	if (!report.writeCSV(reportPath)) {
+		std::cerr << "Could not write report " << reportPath << "\n";
+		return 1;
+	}
+	return 0;
+}
+
+int renderOutOfCore(const char* directory, const unsigned int frames) {
+	Rhodochrosite::OutOfCoreScene scene{ directory };
+	if (!scene.isValid()) {
+		std::cerr << "Could not read bricked scene " << directory << "\n";
+		return 1;
+	}
+	scene.lights.emplace_back(Ruby::DirectionalLight{ Malachite::Vector3f{ -1.0f, -1.0f, -1.0f }.normalize() });
+
+	// Orbits the grid once over the frames, looking at its centre from a little above
+	const Malachite::Vector3f centre = (scene.getMin() + scene.getMax()) * 0.5f;
+	const float distance = (scene.getMax() - scene.getMin()).length();
+	Ruby::Camera orbitCamera{};
+	Rhodochrosite::OutOfCoreRenderer outOfCoreRenderer{ 1280, 720, orbitCamera, scene };
+
+	for (unsigned int frame = 0; frame < frames; frame++) {
+		const float angle = 6.2831853f * static_cast<float>(frame) / static_cast<float>(frames);
+		orbitCamera.position = centre + Malachite::Vector3f{ std::sin(angle) * distance, 0.25f * distance, std::cos(angle) * distance };
+		orbitCamera.front = (centre - orbitCamera.position).normalize();
+
+		outOfCoreRenderer.render();
+		const Rhodochrosite::OutOfCoreFrameStats& stats = outOfCoreRenderer.getStats();
+		std::cout << "Frame " << frame << ": " << stats.seconds * 1000.0 << " ms, cache hit rate " << stats.cache.hitRate() * 100.0f << "%, "
+			<< stats.cache.bytesRead / (1024.0 * 1024.0) << " MiB read, " << stats.cache.evictions << " evictions, "
+			<< stats.brickVisits << " brick visits\n";
+	}
+	return 0;
+}
+
+// Streams count random spheres through a BrickBuilder into directory, never holding more than its write buffers in memory.
+// The cloud fills a 200 unit cube at the same density whatever the count, with about 4096 spheres to a brick.
+int brickSphereCloud(const unsigned long long count, const char* directory) {
+	const float spacing = 200.0f / std::cbrt(static_cast<float>(std::max(count, 1ull)));
+	const auto bricksPerAxis = static_cast<unsigned int>(std::clamp(std::cbrt(static_cast<float>(count) / 4096.0f), 1.0f, 256.0f));
+
+	Rhodochrosite::BrickBuilderSettings settings{};
+	settings.directory = directory;
+	settings.min = Malachite::Vector3f{ -100.0f - spacing };
+	settings.max = Malachite::Vector3f{ 100.0f + spacing };
+	settings.resolution[0] = settings.resolution[1] = settings.resolution[2] = bricksPerAxis;
+
+	Rhodochrosite::BrickBuilder builder{ settings };
+	for (unsigned long long i = 0; i < count; i++) {
+		const Malachite::Vector3f position{ Malachite::random<float>(-100.0f, 100.0f), Malachite::random<float>(-100.0f, 100.0f), Malachite::random<float>(-100.0f, 100.0f) };
+		const Ruby::Colour colour{ Malachite::random<float>(0.2f, 1.0f), Malachite::random<float>(0.2f, 1.0f), Malachite::random<float>(0.2f, 1.0f), 1.0f };
+		builder.add(Rhodochrosite::Sphere{ position, Malachite::random<float>(0.1f, 0.4f) * spacing, colour });
+	}
+	if (!builder.finish()) {
+		std::cerr << "Could not write bricked scene " << directory << "\n";
+		return 1;
+	}
+
+	std::cout << "Bricked " << builder.getSphereCount() << " spheres into " << bricksPerAxis << "^3 bricks in " << directory << "\n";
+	return 0;
+}
@@ -0,0 +1,187 @@
+#include "BrickBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#include "Acceleration/SphereBVH.h"
+#include "OutOfCoreScene.h"
+#include "Scene.h"
+
+namespace Rhodochrosite {
+	BrickBuilder::BrickBuilder(BrickBuilderSettings settings)
+		: m_Settings(std::move(settings)) {
+		for (unsigned int& resolution : m_Settings.resolution) {
+			resolution = std::max(resolution, 1u);
+		}
+
+		// An axis without extent, or with inverted bounds, would have cells of no size, it is widened to one unit instead
+		float* const min[3]{ &m_Settings.min.x, &m_Settings.min.y, &m_Settings.min.z };
+		float* const max[3]{ &m_Settings.max.x, &m_Settings.max.y, &m_Settings.max.z };
+		for (int axis = 0; axis < 3; axis++) {
+			if (!(*max[axis] > *min[axis])) {
+				*max[axis] = *min[axis] + 1.0f;
+			}
+		}
+
+		m_CellSize = Malachite::Vector3f{
+			(m_Settings.max.x - m_Settings.min.x) / static_cast<float>(m_Settings.resolution[0]),
+			(m_Settings.max.y - m_Settings.min.y) / static_cast<float>(m_Settings.resolution[1]),
+			(m_Settings.max.z - m_Settings.min.z) / static_cast<float>(m_Settings.resolution[2])
+		};
+
+		const size_t brickCount = static_cast<size_t>(m_Settings.resolution[0]) * m_Settings.resolution[1] * m_Settings.resolution[2];
+		m_Buffers.resize(brickCount);
+		m_Counts.resize(brickCount, 0);
+		m_NodeCounts.resize(brickCount, 0);
+		m_FlushThreshold = std::max<size_t>(m_Settings.bufferBytes / (brickCount * sizeof(PackedSphere)), 64);
+
+		std::error_code error{};
+		std::filesystem::create_directories(m_Settings.directory, error);
+
+		// Bricks are appended to while building, start from empty files
+		for (unsigned int i = 0; i < brickCount; i++) {
+			std::filesystem::remove(OutOfCoreScene::brickPath(m_Settings.directory, i), error);
+		}
+	}
+
+	BrickBuilder::~BrickBuilder() {
+		if (!m_Finished) {
+			finish();
+		}
+	}
+
+	void BrickBuilder::add(const Sphere& sphere) {
+		const float bounds[2][3]{
+			{ sphere.origin.x - sphere.radius, sphere.origin.y - sphere.radius, sphere.origin.z - sphere.radius },
+			{ sphere.origin.x + sphere.radius, sphere.origin.y + sphere.radius, sphere.origin.z + sphere.radius }
+		};
+		const float min[3]{ m_Settings.min.x, m_Settings.min.y, m_Settings.min.z };
+		const float max[3]{ m_Settings.max.x, m_Settings.max.y, m_Settings.max.z };
+		const float cellSize[3]{ m_CellSize.x, m_CellSize.y, m_CellSize.z };
+
+		int first[3];
+		int last[3];
+		for (int axis = 0; axis < 3; axis++) {
+			// Also drops spheres with NaN coordinates or radius
+			if (!(bounds[1][axis] >= min[axis] && bounds[0][axis] <= max[axis])) {
+				return;
+			}
+
+			// Clamped before converting, a huge sphere's cell would not fit in an int
+			const float highest = static_cast<float>(m_Settings.resolution[axis] - 1);
+			first[axis] = static_cast<int>(std::clamp(std::floor((bounds[0][axis] - min[axis]) / cellSize[axis]), 0.0f, highest));
+			last[axis] = static_cast<int>(std::clamp(std::floor((bounds[1][axis] - min[axis]) / cellSize[axis]), 0.0f, highest));
+		}
+
+		const PackedSphere packed = packSphere(sphere);
+		for (int z = first[2]; z <= last[2]; z++) {
+			for (int y = first[1]; y <= last[1]; y++) {
+				for (int x = first[0]; x <= last[0]; x++) {
+					const unsigned int brick = static_cast<unsigned int>(x + m_Settings.resolution[0] * (y + m_Settings.resolution[1] * z));
+					m_Buffers[brick].push_back(packed);
+					m_Counts[brick]++;
+
+					if (m_Buffers[brick].size() >= m_FlushThreshold) {
+						flush(brick);
+					}
+				}
+			}
+		}
+
+		m_SphereCount++;
+	}
+
+	void BrickBuilder::flush(const unsigned int brick) {
+		std::vector<PackedSphere>& buffer = m_Buffers[brick];
+		if (buffer.empty()) {
+			return;
+		}
+
+		std::ofstream file{ OutOfCoreScene::brickPath(m_Settings.directory, brick), std::ios::binary | std::ios::app };
+		file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size() * sizeof(PackedSphere)));
+		if (!file) {
+			m_Failed = true;
+		}
+
+		buffer.clear();
+		buffer.shrink_to_fit();
+	}
+
+	void BrickBuilder::buildHierarchy(const unsigned int brick) {
+		if (m_Counts[brick] < sphereBVHMinimumSpheres) {
+			return;
+		}
+
+		const std::filesystem::path path = OutOfCoreScene::brickPath(m_Settings.directory, brick);
+		std::vector<PackedSphere> packed(static_cast<size_t>(m_Counts[brick]));
+		{
+			std::ifstream file{ path, std::ios::binary };
+			file.read(reinterpret_cast<char*>(packed.data()), static_cast<std::streamsize>(packed.size() * sizeof(PackedSphere)));
+			if (!file) {
+				m_Failed = true;
+				return;
+			}
+		}
+
+		std::vector<Sphere> spheres;
+		spheres.reserve(packed.size());
+		for (const PackedSphere& sphere : packed) {
+			spheres.push_back(unpackSphere(sphere));
+		}
+
+		// Built once here rather than on every load, the packed spheres are reordered as is so nothing is requantized
+		const std::shared_ptr<const SphereBVH> bvh = SphereBVH::build(spheres);
+		std::vector<PackedSphere> reordered;
+		reordered.reserve(packed.size());
+		for (const unsigned int index : bvh->getIndices()) {
+			reordered.push_back(packed[index]);
+		}
+
+		const std::vector<SphereBVH::Node>& nodes = bvh->getNodes();
+		std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+		file.write(reinterpret_cast<const char*>(reordered.data()), static_cast<std::streamsize>(reordered.size() * sizeof(PackedSphere)));
+		file.write(reinterpret_cast<const char*>(nodes.data()), static_cast<std::streamsize>(nodes.size() * sizeof(SphereBVH::Node)));
+		if (!file) {
+			m_Failed = true;
+			return;
+		}
+
+		m_NodeCounts[brick] = nodes.size();
+	}
+
+	bool BrickBuilder::finish() {
+		m_Finished = true;
+
+		for (unsigned int i = 0; i < m_Buffers.size(); i++) {
+			flush(i);
+		}
+		for (unsigned int i = 0; i < m_Buffers.size(); i++) {
+			buildHierarchy(i);
+		}
+
+		BrickIndexHeader header{};
+		header.min[0] = m_Settings.min.x;
+		header.min[1] = m_Settings.min.y;
+		header.min[2] = m_Settings.min.z;
+		header.max[0] = m_Settings.max.x;
+		header.max[1] = m_Settings.max.y;
+		header.max[2] = m_Settings.max.z;
+		for (int axis = 0; axis < 3; axis++) {
+			header.resolution[axis] = m_Settings.resolution[axis];
+		}
+
+		std::vector<std::uint64_t> counts{ m_Counts.begin(), m_Counts.end() };
+		std::vector<std::uint64_t> nodeCounts{ m_NodeCounts.begin(), m_NodeCounts.end() };
+
+		std::ofstream index{ m_Settings.directory / brickIndexFileName, std::ios::binary | std::ios::trunc };
+		index.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		index.write(reinterpret_cast<const char*>(counts.data()), static_cast<std::streamsize>(counts.size() * sizeof(std::uint64_t)));
+		index.write(reinterpret_cast<const char*>(nodeCounts.data()), static_cast<std::streamsize>(nodeCounts.size() * sizeof(std::uint64_t)));
+		if (!index) {
+			m_Failed = true;
+		}
+
+		return !m_Failed;
+	}
+}
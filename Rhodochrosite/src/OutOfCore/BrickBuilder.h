@@ -0,0 +1,55 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+#include "BrickFormat.h"
+#include "Sphere.h"
+#include "Vector.h"
+
+namespace Rhodochrosite {
+	struct BrickBuilderSettings {
+		std::filesystem::path directory;
+
+		// Spheres outside these bounds are dropped, an axis whose max is not above its min is widened to one unit
+		Malachite::Vector3f min{ -1.0f };
+		Malachite::Vector3f max{ 1.0f };
+		unsigned int resolution[3]{ 16, 16, 16 };
+
+		size_t bufferBytes{ 256 * 1024 * 1024 }; // Shared by all bricks' write buffers
+	};
+
+	// Streams an arbitrarily large sphere set into a uniform grid of bricks on disk.
+	// Spheres straddling brick borders are stored in every brick they overlap.
+	class BrickBuilder {
+	public:
+		explicit BrickBuilder(BrickBuilderSettings settings);
+		~BrickBuilder();
+
+		BrickBuilder(const BrickBuilder& other) = delete;
+		BrickBuilder& operator=(const BrickBuilder& other) = delete;
+
+		void add(const Sphere& sphere);
+
+		// Flushes every brick, builds each brick's hierarchy and writes the index, returns false if anything failed to write
+		bool finish();
+
+		[[nodiscard]] unsigned long long getSphereCount() const { return m_SphereCount; }
+
+	private:
+		BrickBuilderSettings m_Settings;
+		Malachite::Vector3f m_CellSize;
+
+		std::vector<std::vector<PackedSphere>> m_Buffers;
+		std::vector<unsigned long long> m_Counts;
+		std::vector<unsigned long long> m_NodeCounts;
+		size_t m_FlushThreshold;
+
+		unsigned long long m_SphereCount{ 0 };
+		bool m_Failed{ false };
+		bool m_Finished{ false };
+
+		void flush(unsigned int brick);
+		void buildHierarchy(unsigned int brick);
+	};
+}
@@ -0,0 +1,81 @@
+#include "BrickCache.h"
+
+#include <fstream>
+
+namespace Rhodochrosite {
+	size_t LoadedBrick::getBytes() const {
+		return spheres.size() * sizeof(Sphere) + (bvh == nullptr ? 0 : bvh->getBytes());
+	}
+
+	BrickCache::BrickCache(const OutOfCoreScene& scene, const size_t capacityBytes)
+		: m_Scene(scene)
+		, m_CapacityBytes(capacityBytes) { }
+
+	BrickCache::Brick BrickCache::get(const unsigned int brick) {
+		const auto entry = m_Entries.find(brick);
+		if (entry != m_Entries.end()) {
+			m_Stats.hits++;
+			m_Recency.splice(m_Recency.begin(), m_Recency, entry->second.recency);
+			return entry->second.brick;
+		}
+
+		m_Stats.misses++;
+		Brick loaded = load(brick);
+
+		const size_t bytes = loaded->getBytes();
+		evictUntilFits(bytes);
+
+		m_Recency.push_front(brick);
+		m_Entries.emplace(brick, Entry{ loaded, m_Recency.begin() });
+		m_SizeBytes += bytes;
+
+		return loaded;
+	}
+
+	BrickCache::Brick BrickCache::load(const unsigned int brick) {
+		auto loaded = std::make_shared<LoadedBrick>();
+		std::vector<PackedSphere> packed(static_cast<size_t>(m_Scene.getSphereCount(brick)));
+		if (packed.empty()) {
+			return loaded;
+		}
+
+		std::ifstream file{ m_Scene.brickPath(brick), std::ios::binary };
+		file.read(reinterpret_cast<char*>(packed.data()), static_cast<std::streamsize>(packed.size() * sizeof(PackedSphere)));
+
+		const auto bytesRead = static_cast<size_t>(file.gcount());
+		m_Stats.bytesRead += bytesRead;
+
+		// A short read leaves only the spheres that made it off disk, and no hierarchy over them
+		packed.resize(bytesRead / sizeof(PackedSphere));
+
+		loaded->spheres.reserve(packed.size());
+		for (const PackedSphere& sphere : packed) {
+			loaded->spheres.push_back(unpackSphere(sphere));
+		}
+
+		// The hierarchy was built when the brick was written and follows its spheres
+		std::vector<SphereBVH::Node> nodes(static_cast<size_t>(m_Scene.getNodeCount(brick)));
+		if (nodes.empty() || packed.size() != static_cast<size_t>(m_Scene.getSphereCount(brick))) {
+			return loaded;
+		}
+
+		file.read(reinterpret_cast<char*>(nodes.data()), static_cast<std::streamsize>(nodes.size() * sizeof(SphereBVH::Node)));
+		m_Stats.bytesRead += static_cast<size_t>(file.gcount());
+		if (file) {
+			loaded->bvh = SphereBVH::fromNodes(std::move(nodes), static_cast<unsigned int>(loaded->spheres.size()));
+		}
+		return loaded;
+	}
+
+	void BrickCache::evictUntilFits(const size_t incomingBytes) {
+		while (!m_Recency.empty() && m_SizeBytes + incomingBytes > m_CapacityBytes) {
+			const unsigned int victim = m_Recency.back();
+			m_Recency.pop_back();
+
+			const auto entry = m_Entries.find(victim);
+			m_SizeBytes -= entry->second.brick->getBytes();
+			m_Entries.erase(entry);
+			m_Stats.evictions++;
+		}
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "Acceleration/SphereBVH.h"
+#include "BrickFormat.h"
+#include "OutOfCoreScene.h"
+
+namespace Rhodochrosite {
+	struct BrickCacheStats {
+		unsigned long long hits{ 0 };
+		unsigned long long misses{ 0 };
+		unsigned long long bytesRead{ 0 };
+		unsigned long long evictions{ 0 };
+
+		[[nodiscard]] float hitRate() const { return hits + misses == 0 ? 0.0f : static_cast<float>(hits) / static_cast<float>(hits + misses); }
+	};
+
+	// A brick's spheres as loaded, with a hierarchy over them once there are enough to need one
+	struct LoadedBrick {
+		std::vector<Sphere> spheres;
+		std::shared_ptr<const SphereBVH> bvh;
+
+		[[nodiscard]] size_t getBytes() const;
+	};
+
+	// Least recently used cache of loaded bricks, holding at most capacityBytes of sphere and hierarchy data.
+	// Bricks handed out stay alive until released even if they get evicted meanwhile.
+	class BrickCache {
+	public:
+		using Brick = std::shared_ptr<const LoadedBrick>;
+
+		BrickCache(const OutOfCoreScene& scene, size_t capacityBytes);
+
+		[[nodiscard]] Brick get(unsigned int brick);
+		[[nodiscard]] bool contains(const unsigned int brick) const { return m_Entries.find(brick) != m_Entries.end(); }
+
+		[[nodiscard]] const BrickCacheStats& getStats() const { return m_Stats; }
+		void resetStats() { m_Stats = BrickCacheStats{}; }
+
+		[[nodiscard]] size_t getSizeBytes() const { return m_SizeBytes; }
+
+	private:
+		struct Entry {
+			Brick brick;
+			std::list<unsigned int>::iterator recency;
+		};
+
+		const OutOfCoreScene& m_Scene;
+		size_t m_CapacityBytes;
+		size_t m_SizeBytes{ 0 };
+
+		std::list<unsigned int> m_Recency; // Most recently used at the front
+		std::unordered_map<unsigned int, Entry> m_Entries;
+
+		BrickCacheStats m_Stats{};
+
+		[[nodiscard]] Brick load(unsigned int brick);
+		void evictUntilFits(size_t incomingBytes);
+	};
+}
@@ -0,0 +1,29 @@
+#include "BrickFormat.h"
+
+namespace Rhodochrosite {
+	PackedSphere packSphere(const Sphere& sphere) {
+		PackedSphere packed{};
+		packed.origin[0] = sphere.origin.x;
+		packed.origin[1] = sphere.origin.y;
+		packed.origin[2] = sphere.origin.z;
+		packed.radius = sphere.radius;
+
+		const Malachite::Vector4uc colour = sphere.colour.toVec4();
+		packed.colour[0] = colour.x;
+		packed.colour[1] = colour.y;
+		packed.colour[2] = colour.z;
+		packed.colour[3] = colour.w;
+
+		packed.material = static_cast<unsigned char>(sphere.material);
+		return packed;
+	}
+
+	Sphere unpackSphere(const PackedSphere& packed) {
+		return Sphere{
+			Malachite::Vector3f{ packed.origin[0], packed.origin[1], packed.origin[2] },
+			packed.radius,
+			Ruby::Colour{ packed.colour[0], packed.colour[1], packed.colour[2], packed.colour[3] },
+			static_cast<Material>(packed.material)
+		};
+	}
+}
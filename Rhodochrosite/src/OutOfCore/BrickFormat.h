@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Sphere.h"
+#include "Vector.h"
+
+namespace Rhodochrosite {
+	// On disk and in memory layout of a sphere inside a brick
+	struct PackedSphere {
+		float origin[3];
+		float radius;
+		unsigned char colour[4];
+		unsigned char material;
+		unsigned char padding[3];
+	};
+	static_assert(sizeof(PackedSphere) == 24, "PackedSphere is read straight from disk");
+
+	[[nodiscard]] PackedSphere packSphere(const Sphere& sphere);
+	[[nodiscard]] Sphere unpackSphere(const PackedSphere& packed);
+
+	// Header of bricks.index, followed by one std::uint64_t sphere count per brick and then one std::uint64_t
+	// hierarchy node count per brick. A brick file holds its spheres in leaf order followed by its SphereBVH nodes.
+	struct BrickIndexHeader {
+		char magic[4]{ 'R', 'B', 'R', 'K' };
+		std::uint32_t version{ 2 };
+		float min[3]{ 0.0f, 0.0f, 0.0f };
+		float max[3]{ 0.0f, 0.0f, 0.0f };
+		std::uint32_t resolution[3]{ 1, 1, 1 };
+		std::uint32_t padding{ 0 };
+	};
+
+	constexpr const char* brickIndexFileName = "bricks.index";
+}
@@ -0,0 +1,263 @@
+#include "OutOfCoreRenderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "Rendering/Renderer.h"
+
+namespace Rhodochrosite {
+	OutOfCoreRenderer::OutOfCoreRenderer(const unsigned int width, const unsigned int height, Ruby::Camera& camera, const OutOfCoreScene& scene, OutOfCoreSettings settings)
+		: m_RenderImage(Malachite::Vector4f{ 1.0f }, width, height)
+		, m_Width(width)
+		, m_Height(height)
+		, m_Camera(camera)
+		, m_Scene(scene)
+		, m_Settings(settings)
+		, m_Cache(scene, settings.cacheBytes)
+		, m_Queues(scene.getBrickCount()) { }
+
+	void OutOfCoreRenderer::render() {
+		const auto start = std::chrono::steady_clock::now();
+
+		m_Stats = OutOfCoreFrameStats{};
+		m_Cache.resetStats();
+
+		const unsigned int pixelCount = m_Width * m_Height;
+		const unsigned int waveSize = std::max(m_Settings.raysPerWave, 1u);
+		for (unsigned int first = 0; first < pixelCount; first += waveSize) {
+			renderWave(first, std::min(waveSize, pixelCount - first));
+		}
+
+		m_Stats.cache = m_Cache.getStats();
+		m_Stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	void OutOfCoreRenderer::renderWave(const unsigned int firstPixel, const unsigned int pixelCount) {
+		m_Rays.clear();
+		m_Rays.reserve(pixelCount);
+
+		for (unsigned int i = 0; i < pixelCount; i++) {
+			const unsigned int pixel = firstPixel + i;
+
+			RayState state{};
+			state.pixel = pixel;
+			state.ray = Renderer::cameraRay(m_Camera, Renderer::pixelToTexCords(pixel % m_Width, pixel / m_Width, m_Width, m_Height));
+
+			m_Rays.push_back(state);
+			if (enterGrid(m_Rays.back())) {
+				enqueue(static_cast<unsigned int>(m_Rays.size() - 1));
+			}
+		}
+
+		for (unsigned int brick = nextBrickToProcess(); brick != noBrick; brick = nextBrickToProcess()) {
+			processBrick(brick);
+		}
+
+		for (const RayState& state : m_Rays) {
+			shade(state);
+		}
+	}
+
+	bool OutOfCoreRenderer::enterGrid(RayState& state) const {
+		const Malachite::Vector3f min = m_Scene.getMin();
+		const Malachite::Vector3f max = m_Scene.getMax();
+		const Malachite::Vector3f cellSize = m_Scene.getCellSize();
+
+		const float origin[3]{ state.ray.origin.x, state.ray.origin.y, state.ray.origin.z };
+		const float direction[3]{ state.ray.direction.x, state.ray.direction.y, state.ray.direction.z };
+		const float low[3]{ min.x, min.y, min.z };
+		const float high[3]{ max.x, max.y, max.z };
+		const float size[3]{ cellSize.x, cellSize.y, cellSize.z };
+
+		// Slab test against the whole grid
+		float entry = 0.0f;
+		float exit = std::numeric_limits<float>::max();
+		for (int axis = 0; axis < 3; axis++) {
+			if (std::abs(direction[axis]) < 1e-12f) {
+				if (origin[axis] < low[axis] || origin[axis] > high[axis]) {
+					return false;
+				}
+				continue;
+			}
+
+			float nearDistance = (low[axis] - origin[axis]) / direction[axis];
+			float farDistance = (high[axis] - origin[axis]) / direction[axis];
+			if (nearDistance > farDistance) {
+				std::swap(nearDistance, farDistance);
+			}
+
+			entry = std::max(entry, nearDistance);
+			exit = std::min(exit, farDistance);
+		}
+
+		if (entry > exit) {
+			return false;
+		}
+
+		for (int axis = 0; axis < 3; axis++) {
+			const float position = origin[axis] + direction[axis] * entry;
+			const int highest = static_cast<int>(m_Scene.getResolution(axis)) - 1;
+			state.cell[axis] = std::clamp(static_cast<int>(std::floor((position - low[axis]) / size[axis])), 0, highest);
+
+			if (std::abs(direction[axis]) < 1e-12f) {
+				state.step[axis] = 0;
+				state.nextBoundary[axis] = std::numeric_limits<float>::max();
+				state.boundarySpacing[axis] = std::numeric_limits<float>::max();
+				continue;
+			}
+
+			state.step[axis] = direction[axis] > 0.0f ? 1 : -1;
+			const float boundary = low[axis] + static_cast<float>(state.cell[axis] + (state.step[axis] > 0 ? 1 : 0)) * size[axis];
+			state.nextBoundary[axis] = (boundary - origin[axis]) / direction[axis];
+			state.boundarySpacing[axis] = size[axis] / std::abs(direction[axis]);
+		}
+
+		if (m_Scene.getSphereCount(currentBrick(state)) == 0) {
+			return advance(state);
+		}
+
+		return true;
+	}
+
+	bool OutOfCoreRenderer::advance(RayState& state) const {
+		do {
+			int axis = 0;
+			if (state.nextBoundary[1] < state.nextBoundary[axis]) { axis = 1; }
+			if (state.nextBoundary[2] < state.nextBoundary[axis]) { axis = 2; }
+
+			// Nothing further along the ray can be closer than the hit we already have
+			if (state.hitSomething && state.distanceToHit <= state.nextBoundary[axis]) {
+				return false;
+			}
+
+			state.cell[axis] += state.step[axis];
+			if (state.cell[axis] < 0 || state.cell[axis] >= static_cast<int>(m_Scene.getResolution(axis))) {
+				return false;
+			}
+
+			state.nextBoundary[axis] += state.boundarySpacing[axis];
+		} while (m_Scene.getSphereCount(currentBrick(state)) == 0);
+
+		return true;
+	}
+
+	unsigned int OutOfCoreRenderer::currentBrick(const RayState& state) const {
+		return m_Scene.brickIndex(static_cast<unsigned int>(state.cell[0]), static_cast<unsigned int>(state.cell[1]), static_cast<unsigned int>(state.cell[2]));
+	}
+
+	float OutOfCoreRenderer::cellExit(const RayState& state) const {
+		return std::min(state.nextBoundary[0], std::min(state.nextBoundary[1], state.nextBoundary[2]));
+	}
+
+	void OutOfCoreRenderer::enqueue(const unsigned int ray) {
+		const unsigned int brick = currentBrick(m_Rays[ray]);
+		m_Queues[brick].push_back(ray);
+
+		const QueuedBrick entry{ m_Queues[brick].size(), brick };
+		if (m_Cache.contains(brick)) {
+			m_ResidentBricks.push(entry);
+		}
+		else {
+			m_NonResidentBricks.push(entry);
+		}
+	}
+
+	unsigned int OutOfCoreRenderer::nextBrickToProcess() {
+		// Resident bricks first so they are drained before being evicted, then whichever brick has the most rays waiting
+		while (!m_ResidentBricks.empty()) {
+			const auto [length, brick] = m_ResidentBricks.top();
+			m_ResidentBricks.pop();
+			if (m_Queues[brick].size() != length) {
+				continue;
+			}
+
+			// Evicted since it was queued
+			if (!m_Cache.contains(brick)) {
+				m_NonResidentBricks.push(QueuedBrick{ length, brick });
+				continue;
+			}
+			return brick;
+		}
+
+		while (!m_NonResidentBricks.empty()) {
+			const auto [length, brick] = m_NonResidentBricks.top();
+			m_NonResidentBricks.pop();
+			if (m_Queues[brick].size() == length) {
+				return brick;
+			}
+		}
+		return noBrick;
+	}
+
+	void OutOfCoreRenderer::processBrick(const unsigned int brick) {
+		std::vector<unsigned int> rays{};
+		rays.swap(m_Queues[brick]);
+
+		const BrickCache::Brick spheres = m_Cache.get(brick);
+		m_Stats.brickVisits++;
+		m_Stats.rayBrickTests += rays.size();
+
+		for (const unsigned int rayIndex : rays) {
+			RayState& state = m_Rays[rayIndex];
+
+			const Sphere* hit = nullptr;
+			if (spheres->bvh != nullptr) {
+				const unsigned int index = spheres->bvh->closestHit(state.ray, spheres->spheres, state.distanceToHit);
+				if (index != SphereBVH::noHit) {
+					hit = &spheres->spheres[index];
+				}
+			}
+			else {
+				for (const Sphere& sphere : spheres->spheres) {
+					const float hitDistance = state.ray.hitSphere(sphere);
+					if (hitDistance > 0.0f && hitDistance < state.distanceToHit) {
+						state.distanceToHit = hitDistance;
+						hit = &sphere;
+					}
+				}
+			}
+
+			if (hit != nullptr) {
+				state.hitSphere = packSphere(*hit);
+				state.hitSomething = true;
+			}
+
+			// A hit beyond this cell may still lose to a sphere stored in a later brick
+			if (state.hitSomething && state.distanceToHit <= cellExit(state)) {
+				continue;
+			}
+
+			if (advance(state)) {
+				enqueue(rayIndex);
+			}
+		}
+	}
+
+	void OutOfCoreRenderer::shade(const RayState& state) {
+		std::vector<unsigned char>& content = m_RenderImage.getContent();
+		const size_t index = static_cast<size_t>(state.pixel) * 4;
+
+		if (!state.hitSomething) {
+			content[index + 0] = 0;
+			content[index + 1] = 0;
+			content[index + 2] = 0;
+			content[index + 3] = 255;
+			return;
+		}
+
+		const Malachite::Vector3f centre{ state.hitSphere.origin[0], state.hitSphere.origin[1], state.hitSphere.origin[2] };
+		const Malachite::Vector3f normal = (state.ray.at(state.distanceToHit) - centre).normalize();
+
+		float lightIntensity{ 0.0f };
+		for (const Ruby::DirectionalLight& light : m_Scene.lights) {
+			lightIntensity += Malachite::max(dot(normal, -light.direction), 0.0f);
+		}
+		lightIntensity = Malachite::clamp(lightIntensity, 0.0f, 1.0f);
+
+		for (int channel = 0; channel < 3; channel++) {
+			content[index + channel] = static_cast<unsigned char>(static_cast<float>(state.hitSphere.colour[channel]) * lightIntensity);
+		}
+		content[index + 3] = 255;
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "BrickCache.h"
+#include "Camera.h"
+#include "OutOfCoreScene.h"
+#include "Ray.h"
+#include "Resources/Image.h"
+
+namespace Rhodochrosite {
+	struct OutOfCoreSettings {
+		size_t cacheBytes{ 1024ull * 1024 * 1024 };
+		unsigned int raysPerWave{ 1u << 18 }; // Bounds the memory used for ray state
+	};
+
+	struct OutOfCoreFrameStats {
+		BrickCacheStats cache{};
+		unsigned long long brickVisits{ 0 };  // Times a brick's queue was processed
+		unsigned long long rayBrickTests{ 0 }; // Rays tested against a brick
+		double seconds{ 0.0 };
+	};
+
+	// Renders an OutOfCoreScene with the basic lighting algorithm. Rays are queued on the brick they
+	// are about to enter and each brick is loaded once for its whole queue, instead of once per ray.
+	class OutOfCoreRenderer {
+	public:
+		OutOfCoreRenderer(unsigned int width, unsigned int height, Ruby::Camera& camera, const OutOfCoreScene& scene, OutOfCoreSettings settings = OutOfCoreSettings{});
+
+		void render();
+		Ruby::Image& getImage() { return m_RenderImage; }
+
+		[[nodiscard]] const OutOfCoreFrameStats& getStats() const { return m_Stats; }
+
+	private:
+		struct RayState {
+			Ray ray;
+			unsigned int pixel{ 0 };
+
+			// Grid traversal
+			int cell[3]{ 0, 0, 0 };
+			int step[3]{ 0, 0, 0 };
+			float nextBoundary[3]{ 0.0f, 0.0f, 0.0f };
+			float boundarySpacing[3]{ 0.0f, 0.0f, 0.0f };
+
+			// Closest hit so far
+			float distanceToHit{ std::numeric_limits<float>::max() };
+			PackedSphere hitSphere{};
+			bool hitSomething{ false };
+		};
+
+		Ruby::Image m_RenderImage;
+		unsigned int m_Width;
+		unsigned int m_Height;
+
+		Ruby::Camera& m_Camera;
+		const OutOfCoreScene& m_Scene;
+		OutOfCoreSettings m_Settings;
+
+		BrickCache m_Cache;
+		OutOfCoreFrameStats m_Stats{};
+
+		std::vector<RayState> m_Rays;
+		std::vector<std::vector<unsigned int>> m_Queues; // Ray indices waiting on each brick
+
+		// Queued bricks by queue length, resident ones apart. Every enqueue pushes the brick's new length and entries
+		// whose length no longer matches the queue are skipped when they come up.
+		using QueuedBrick = std::pair<size_t, unsigned int>;
+		std::priority_queue<QueuedBrick> m_ResidentBricks;
+		std::priority_queue<QueuedBrick> m_NonResidentBricks;
+		static constexpr unsigned int noBrick = std::numeric_limits<unsigned int>::max();
+
+		[[nodiscard]] bool enterGrid(RayState& state) const;
+		[[nodiscard]] bool advance(RayState& state) const; // Moves to the next non-empty brick
+		[[nodiscard]] unsigned int currentBrick(const RayState& state) const;
+		[[nodiscard]] float cellExit(const RayState& state) const;
+
+		void enqueue(unsigned int ray);
+		[[nodiscard]] unsigned int nextBrickToProcess(); // noBrick once every queue is empty
+		void processBrick(unsigned int brick);
+
+		void renderWave(unsigned int firstPixel, unsigned int pixelCount);
+		void shade(const RayState& state);
+	};
+}
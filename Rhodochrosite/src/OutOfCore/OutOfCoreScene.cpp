@@ -0,0 +1,60 @@
+#include "OutOfCoreScene.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace Rhodochrosite {
+	OutOfCoreScene::OutOfCoreScene(std::filesystem::path directory)
+		: m_Directory(std::move(directory)) {
+		std::ifstream index{ m_Directory / brickIndexFileName, std::ios::binary };
+		if (!index) {
+			return;
+		}
+
+		BrickIndexHeader header{};
+		index.read(reinterpret_cast<char*>(&header), sizeof(header));
+		if (!index || std::memcmp(header.magic, BrickIndexHeader{}.magic, sizeof(header.magic)) != 0 || header.version != BrickIndexHeader{}.version) {
+			return;
+		}
+
+		for (int axis = 0; axis < 3; axis++) {
+			if (header.resolution[axis] == 0 || !(header.max[axis] > header.min[axis])) {
+				return;
+			}
+		}
+
+		m_Min = Malachite::Vector3f{ header.min[0], header.min[1], header.min[2] };
+		m_Max = Malachite::Vector3f{ header.max[0], header.max[1], header.max[2] };
+		for (int axis = 0; axis < 3; axis++) {
+			m_Resolution[axis] = header.resolution[axis];
+		}
+		m_CellSize = Malachite::Vector3f{
+			(m_Max.x - m_Min.x) / static_cast<float>(m_Resolution[0]),
+			(m_Max.y - m_Min.y) / static_cast<float>(m_Resolution[1]),
+			(m_Max.z - m_Min.z) / static_cast<float>(m_Resolution[2])
+		};
+
+		std::vector<std::uint64_t> counts(static_cast<size_t>(m_Resolution[0]) * m_Resolution[1] * m_Resolution[2]);
+		std::vector<std::uint64_t> nodeCounts(counts.size());
+		index.read(reinterpret_cast<char*>(counts.data()), static_cast<std::streamsize>(counts.size() * sizeof(std::uint64_t)));
+		index.read(reinterpret_cast<char*>(nodeCounts.data()), static_cast<std::streamsize>(nodeCounts.size() * sizeof(std::uint64_t)));
+		if (!index) {
+			return;
+		}
+
+		m_SphereCounts.assign(counts.begin(), counts.end());
+		m_NodeCounts.assign(nodeCounts.begin(), nodeCounts.end());
+		m_Valid = true;
+	}
+
+	unsigned int OutOfCoreScene::brickIndex(const unsigned int x, const unsigned int y, const unsigned int z) const {
+		return x + m_Resolution[0] * (y + m_Resolution[1] * z);
+	}
+
+	std::filesystem::path OutOfCoreScene::brickPath(const std::filesystem::path& directory, const unsigned int brick) {
+		char name[32];
+		std::snprintf(name, sizeof(name), "brick_%07u.bin", brick);
+		return directory / name;
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+#include "BrickFormat.h"
+#include "Lights.h"
+#include "Vector.h"
+
+namespace Rhodochrosite {
+	// The small in memory part of an out of core scene, the brick grid and how many spheres each brick holds.
+	// Sphere data stays on disk until a BrickCache pages it in.
+	class OutOfCoreScene {
+	public:
+		explicit OutOfCoreScene(std::filesystem::path directory);
+
+		[[nodiscard]] bool isValid() const { return m_Valid; }
+
+		[[nodiscard]] Malachite::Vector3f getMin() const { return m_Min; }
+		[[nodiscard]] Malachite::Vector3f getMax() const { return m_Max; }
+		[[nodiscard]] Malachite::Vector3f getCellSize() const { return m_CellSize; }
+		[[nodiscard]] unsigned int getResolution(const int axis) const { return m_Resolution[axis]; }
+
+		[[nodiscard]] unsigned int getBrickCount() const { return static_cast<unsigned int>(m_SphereCounts.size()); }
+		[[nodiscard]] unsigned int brickIndex(unsigned int x, unsigned int y, unsigned int z) const;
+		[[nodiscard]] unsigned long long getSphereCount(const unsigned int brick) const { return m_SphereCounts[brick]; }
+		[[nodiscard]] unsigned long long getNodeCount(const unsigned int brick) const { return m_NodeCounts[brick]; }
+		[[nodiscard]] std::filesystem::path brickPath(const unsigned int brick) const { return brickPath(m_Directory, brick); }
+
+		[[nodiscard]] static std::filesystem::path brickPath(const std::filesystem::path& directory, unsigned int brick);
+
+		std::vector<Ruby::DirectionalLight> lights;
+
+	private:
+		std::filesystem::path m_Directory;
+		bool m_Valid{ false };
+
+		Malachite::Vector3f m_Min{ 0.0f };
+		Malachite::Vector3f m_Max{ 0.0f };
+		Malachite::Vector3f m_CellSize{ 0.0f };
+		unsigned int m_Resolution[3]{ 0, 0, 0 };
+
+		std::vector<unsigned long long> m_SphereCounts;
+		std::vector<unsigned long long> m_NodeCounts;
+	};
+}
@@ -0,0 +1,51 @@
+#include "PPM.h"
+
+#include <fstream>
+
+namespace Rhodochrosite {
+	std::string ppmHeader(const unsigned int width, const unsigned int height) {
+		return "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+	}
+
+	std::vector<unsigned char> encodePPM(const std::vector<unsigned char>& rgba, const unsigned int width, const unsigned int height) {
+		const std::string header = ppmHeader(width, height);
+
+		std::vector<unsigned char> encoded{};
+		encoded.reserve(header.size() + static_cast<size_t>(width) * height * 3);
+		encoded.insert(encoded.end(), header.begin(), header.end());
+
+		// PPM is stored top row first
+		for (unsigned int row = 0; row < height; row++) {
+			const size_t y = height - 1 - row;
+			for (unsigned int x = 0; x < width; x++) {
+				const size_t index = (x + y * width) * 4;
+				encoded.push_back(rgba[index + 0]);
+				encoded.push_back(rgba[index + 1]);
+				encoded.push_back(rgba[index + 2]);
+			}
+		}
+
+		return encoded;
+	}
+
+	bool writeFileAtomically(const std::filesystem::path& path, const std::vector<unsigned char>& data) {
+		std::filesystem::path temporaryPath = path;
+		temporaryPath += ".tmp";
+
+		{
+			std::ofstream file{ temporaryPath, std::ios::binary | std::ios::trunc };
+			if (!file) {
+				return false;
+			}
+
+			file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+			if (!file) {
+				return false;
+			}
+		}
+
+		std::error_code error{};
+		std::filesystem::rename(temporaryPath, path, error);
+		return !error;
+	}
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Rhodochrosite {
+	// Encodes an RGBA8 image stored bottom row first (the layout Renderer produces) as a binary PPM.
+	[[nodiscard]] std::vector<unsigned char> encodePPM(const std::vector<unsigned char>& rgba, unsigned int width, unsigned int height);
+
+	[[nodiscard]] std::string ppmHeader(unsigned int width, unsigned int height);
+
+	// Writes to a temporary file next to path and renames it, so a crash never leaves a truncated file behind.
+	bool writeFileAtomically(const std::filesystem::path& path, const std::vector<unsigned char>& data);
+}
@@ -0,0 +1,84 @@
+#include "PixelFormat.h"
+
+#include <cstring>
+
+namespace Rhodochrosite {
+	unsigned int bytesPerPixel(const PixelFormat format) {
+		switch (format) {
+		case PixelFormat::RGB_FLOAT:
+			return 3 * sizeof(float);
+		case PixelFormat::RGBA_HALF:
+			return 4 * sizeof(std::uint16_t);
+		default:
+		case PixelFormat::RGBA8:
+			return 4;
+		}
+	}
+
+	std::uint16_t floatToHalf(const float value) {
+		std::uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+
+		const auto sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000u);
+		const std::uint32_t exponent = (bits >> 23) & 0xffu;
+		std::uint32_t mantissa = bits & 0x7fffffu;
+
+		// Infinity and NaN, keeping NaNs quiet
+		if (exponent == 0xffu) {
+			return static_cast<std::uint16_t>(sign | 0x7c00u | (mantissa != 0 ? 0x200u : 0u));
+		}
+
+		const int halfExponent = static_cast<int>(exponent) - 127 + 15;
+		if (halfExponent >= 0x1f) {
+			return static_cast<std::uint16_t>(sign | 0x7c00u); // Too large, becomes infinity
+		}
+
+		if (halfExponent <= 0) {
+			// Subnormal half or zero
+			if (halfExponent < -10) {
+				return sign;
+			}
+
+			mantissa |= 0x800000u;
+			const auto shift = static_cast<std::uint32_t>(14 - halfExponent);
+			std::uint32_t halfMantissa = mantissa >> shift;
+			const std::uint32_t remainder = mantissa & ((1u << shift) - 1u);
+			const std::uint32_t halfway = 1u << (shift - 1u);
+			if (remainder > halfway || (remainder == halfway && (halfMantissa & 1u) != 0)) {
+				halfMantissa++;
+			}
+			return static_cast<std::uint16_t>(sign | halfMantissa);
+		}
+
+		// Round to nearest even, a carry out of the mantissa correctly bumps the exponent
+		std::uint32_t half = (static_cast<std::uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+		const std::uint32_t remainder = mantissa & 0x1fffu;
+		if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u) != 0)) {
+			half++;
+		}
+		return static_cast<std::uint16_t>(sign | half);
+	}
+
+	void writePixel(const PixelFormat format, const Ruby::Colour& colour, unsigned char* pixel) {
+		switch (format) {
+		case PixelFormat::RGBA8: {
+			const Malachite::Vector4uc colourData = colour.toVec4();
+			pixel[0] = colourData.x;
+			pixel[1] = colourData.y;
+			pixel[2] = colourData.z;
+			pixel[3] = colourData.w;
+			break;
+		}
+		case PixelFormat::RGB_FLOAT: {
+			const float channels[3]{ colour.colour.x, colour.colour.y, colour.colour.z };
+			std::memcpy(pixel, channels, sizeof(channels));
+			break;
+		}
+		case PixelFormat::RGBA_HALF: {
+			const std::uint16_t channels[4]{ floatToHalf(colour.colour.x), floatToHalf(colour.colour.y), floatToHalf(colour.colour.z), floatToHalf(colour.colour.w) };
+			std::memcpy(pixel, channels, sizeof(channels));
+			break;
+		}
+		}
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Utility/Colour.h"
+
+namespace Rhodochrosite {
+	enum class PixelFormat {
+		RGBA8,     // 4 unsigned bytes, the layout of Renderer::getImage()
+		RGB_FLOAT, // 3 floats, not clamped
+		RGBA_HALF  // 4 IEEE half floats, not clamped
+	};
+
+	[[nodiscard]] unsigned int bytesPerPixel(PixelFormat format);
+
+	[[nodiscard]] std::uint16_t floatToHalf(float value);
+
+	// pixel must have room for bytesPerPixel(format) bytes, it does not need to be aligned
+	void writePixel(PixelFormat format, const Ruby::Colour& colour, unsigned char* pixel);
+}
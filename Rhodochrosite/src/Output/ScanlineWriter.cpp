@@ -0,0 +1,38 @@
+#include "ScanlineWriter.h"
+
+#include "PPM.h"
+
+namespace Rhodochrosite {
+	PPMScanlineWriter::PPMScanlineWriter(std::filesystem::path path)
+		: m_Path(std::move(path)) { }
+
+	bool PPMScanlineWriter::begin(const unsigned int width, const unsigned int height) {
+		m_Width = width;
+		m_Row.resize(static_cast<size_t>(width) * 3);
+
+		m_File.open(m_Path, std::ios::binary | std::ios::trunc);
+		const std::string header = ppmHeader(width, height);
+		m_File.write(header.data(), static_cast<std::streamsize>(header.size()));
+		return static_cast<bool>(m_File);
+	}
+
+	bool PPMScanlineWriter::writeRows(const unsigned char* firstRow, const unsigned int rowCount, const std::ptrdiff_t rowPitch) {
+		for (unsigned int row = 0; row < rowCount; row++) {
+			const unsigned char* rgba = firstRow + rowPitch * static_cast<std::ptrdiff_t>(row);
+			for (unsigned int x = 0; x < m_Width; x++) {
+				m_Row[x * 3 + 0] = rgba[x * 4 + 0];
+				m_Row[x * 3 + 1] = rgba[x * 4 + 1];
+				m_Row[x * 3 + 2] = rgba[x * 4 + 2];
+			}
+
+			m_File.write(reinterpret_cast<const char*>(m_Row.data()), static_cast<std::streamsize>(m_Row.size()));
+		}
+
+		return static_cast<bool>(m_File);
+	}
+
+	bool PPMScanlineWriter::end() {
+		m_File.close();
+		return !m_File.fail();
+	}
+}
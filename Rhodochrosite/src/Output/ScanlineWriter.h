@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace Rhodochrosite {
+	// Receives an image a few rows at a time, top row first, so the whole image never has to exist in memory
+	class ScanlineWriter {
+	public:
+		virtual ~ScanlineWriter() = default;
+
+		virtual bool begin(unsigned int width, unsigned int height) = 0;
+
+		// rowPitch is the byte offset from one row to the next row down, it may be negative
+		virtual bool writeRows(const unsigned char* firstRow, unsigned int rowCount, std::ptrdiff_t rowPitch) = 0;
+
+		virtual bool end() = 0;
+	};
+
+	// Binary PPM, written straight through to disk as rows arrive
+	class PPMScanlineWriter : public ScanlineWriter {
+	public:
+		explicit PPMScanlineWriter(std::filesystem::path path);
+
+		bool begin(unsigned int width, unsigned int height) override;
+		bool writeRows(const unsigned char* firstRow, unsigned int rowCount, std::ptrdiff_t rowPitch) override;
+		bool end() override;
+
+	private:
+		std::filesystem::path m_Path;
+		std::ofstream m_File;
+		unsigned int m_Width{ 0 };
+		std::vector<unsigned char> m_Row;
+	};
+}
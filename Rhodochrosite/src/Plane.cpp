@@ -0,0 +1,13 @@
+#include "Plane.h"
+
+namespace Rhodochrosite {
+	Plane::Plane(const Malachite::Vector3f Origin, const Malachite::Vector3f Normal, Ruby::Colour Colour, Material mat)
+		: origin(Origin), normal(Normal.normalize()), colour(Colour), material(mat) {
+
+	}
+
+	Disc::Disc(const Malachite::Vector3f Origin, const Malachite::Vector3f Normal, float Radius, Ruby::Colour Colour, Material mat)
+		: origin(Origin), normal(Normal.normalize()), radius(Radius), colour(Colour), material(mat) {
+
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Sphere.h"
+#include "Utility/Colour.h"
+#include "Vector.h"
+
+namespace Rhodochrosite {
+	// Infinite plane through origin
+	struct Plane {
+		Plane() = default;
+		Plane(Malachite::Vector3f origin, Malachite::Vector3f normal, Ruby::Colour colour, Material = Material::DIFFUSE);
+
+		Malachite::Vector3f origin;
+		Malachite::Vector3f normal{ Malachite::Vector3f::up };
+		Ruby::Colour colour{ 0, 0, 0, 255 };
+		Material material{ Material::DIFFUSE };
+	};
+
+	struct Disc {
+		Disc() = default;
+		Disc(Malachite::Vector3f origin, Malachite::Vector3f normal, float radius, Ruby::Colour colour, Material = Material::DIFFUSE);
+
+		Malachite::Vector3f origin;
+		Malachite::Vector3f normal{ Malachite::Vector3f::up };
+		float radius{ 0.0f };
+		Ruby::Colour colour{ 0, 0, 0, 255 };
+		Material material{ Material::DIFFUSE };
+	};
+}
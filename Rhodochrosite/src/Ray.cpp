@@ -20,6 +20,29 @@ namespace Rhodochrosite {
 		return (-halfB - std::sqrt(discriminant)) / a;
 	}
 
+	float Ray::hitPlane(const Plane& plane) const {
+		const float denominator = dot(direction, plane.normal);
+		if (std::abs(denominator) < 1e-6f) {
+			return 0.0f;
+		}
+
+		return dot(plane.origin - origin, plane.normal) / denominator;
+	}
+
+	float Ray::hitDisc(const Disc& disc) const {
+		const float denominator = dot(direction, disc.normal);
+		if (std::abs(denominator) < 1e-6f) {
+			return 0.0f;
+		}
+
+		const float distance = dot(disc.origin - origin, disc.normal) / denominator;
+		if ((at(distance) - disc.origin).lengthSquared() > disc.radius * disc.radius) {
+			return 0.0f;
+		}
+
+		return distance;
+	}
+
 	Malachite::Vector3f Ray::at(const float distance) const {
 		return distance * direction + origin;
 	}
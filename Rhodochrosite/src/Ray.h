@@ -1,4 +1,5 @@
 #pragma once
+#include "Plane.h"
 #include "Sphere.h"
 #include "Vector.h"
 
@@ -8,6 +9,8 @@ namespace Rhodochrosite {
 		Ray(Malachite::Vector3f origin, Malachite::Vector3f direction);
 
 		[[nodiscard]] float hitSphere(const Sphere& sphere) const;
+		[[nodiscard]] float hitPlane(const Plane& plane) const;
+		[[nodiscard]] float hitDisc(const Disc& disc) const;
 		[[nodiscard]] Malachite::Vector3f at(float distance) const;
 
 		Malachite::Vector3f origin;
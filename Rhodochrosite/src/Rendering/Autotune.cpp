@@ -0,0 +1,217 @@
+#include "Autotune.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	#include <intrin.h>
+	#define RHODOCHROSITE_CPUID_MSVC
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+	#include <cpuid.h>
+	#define RHODOCHROSITE_CPUID_GCC
+#endif
+
+#include "Scenes.h"
+
+namespace Rhodochrosite {
+	namespace {
+		std::string cpuBrandString() {
+			unsigned int registers[12]{};
+#if defined(RHODOCHROSITE_CPUID_MSVC)
+			int info[4]{};
+			__cpuid(info, 0x80000000);
+			if (static_cast<unsigned int>(info[0]) < 0x80000004) {
+				return {};
+			}
+			for (int leaf = 0; leaf < 3; leaf++) {
+				__cpuid(info, 0x80000002 + leaf);
+				std::memcpy(registers + leaf * 4, info, sizeof(info));
+			}
+#elif defined(RHODOCHROSITE_CPUID_GCC)
+			for (unsigned int leaf = 0; leaf < 3; leaf++) {
+				if (!__get_cpuid(0x80000002 + leaf, &registers[leaf * 4], &registers[leaf * 4 + 1], &registers[leaf * 4 + 2], &registers[leaf * 4 + 3])) {
+					return {};
+				}
+			}
+#else
+			return {};
+#endif
+			char brand[sizeof(registers) + 1]{};
+			std::memcpy(brand, registers, sizeof(registers));
+
+			// Brand strings are padded with spaces, and the model is the key so tabs cannot appear in it
+			std::string model{ brand };
+			std::replace(model.begin(), model.end(), '\t', ' ');
+			const size_t first = model.find_first_not_of(' ');
+			const size_t last = model.find_last_not_of(' ');
+			return first == std::string::npos ? std::string{} : model.substr(first, last - first + 1);
+		}
+
+		struct Workload {
+			SceneSnapshot scene;
+			Renderer::PerPixelAlgorithm algorithm;
+		};
+
+		// Static snapshots drop their binary BVH, so traversals are compared on copies that keep one like DynamicScene's do
+		SceneSnapshot withBinaryBVH(const SceneSnapshot& snapshot) {
+			if (snapshot->sphereBVH != nullptr || snapshot->spheres.size() < sphereBVHMinimumSpheres) {
+				return snapshot;
+			}
+
+			Scene scene = *snapshot;
+			scene.sphereBVH = SphereBVH::build(scene.spheres);
+			return makeSnapshot(std::move(scene));
+		}
+
+		double secondsSince(const std::chrono::steady_clock::time_point start) {
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		double measure(const TuningConfig& config, const std::vector<Workload>& workloads, const AutotuneSettings& settings) {
+			ThreadPool pool{ config.threadCount == 0 ? std::thread::hardware_concurrency() : config.threadCount };
+			Ruby::Camera camera{};
+			Renderer renderer{ settings.width, settings.height, camera, pool };
+			applyTuning(config, renderer);
+
+			double total = 0.0;
+			for (const Workload& workload : workloads) {
+				renderer.setScene(workload.scene);
+				renderer.setAlgorithm(workload.algorithm);
+
+				double best = std::numeric_limits<double>::max();
+				for (unsigned int i = 0; i < std::max(settings.repeats, 1u); i++) {
+					const auto start = std::chrono::steady_clock::now();
+					renderer.render();
+					best = std::min(best, secondsSince(start));
+				}
+				total += best;
+			}
+			return total;
+		}
+
+		// Sets one field of config to whichever candidate renders fastest
+		template<typename Value>
+		void tune(TuningConfig& config, Value TuningConfig::* field, const std::vector<Value>& candidates, const std::vector<Workload>& workloads, const AutotuneSettings& settings) {
+			double bestSeconds = std::numeric_limits<double>::max();
+			Value bestValue = config.*field;
+			for (const Value& candidate : candidates) {
+				TuningConfig trial = config;
+				trial.*field = candidate;
+
+				const double seconds = measure(trial, workloads, settings);
+				if (seconds < bestSeconds) {
+					bestSeconds = seconds;
+					bestValue = candidate;
+				}
+			}
+			config.*field = bestValue;
+		}
+
+		const char* traversalName(const SphereTraversal traversal) {
+			return traversal == SphereTraversal::BINARY_BVH ? "binary" : "wide";
+		}
+	}
+
+	MachineKey MachineKey::current() {
+		std::string model = cpuBrandString();
+		return MachineKey{ model.empty() ? "unknown" : std::move(model), std::thread::hardware_concurrency() };
+	}
+
+	TuningConfig autotune(const Scenes& scenes, const AutotuneSettings& settings) {
+		// Few large spheres, a scene with a BVH, many lights and one that bounces
+		const std::vector<Workload> workloads{
+			Workload{ scenes.lotsOfSpheres, &Renderer::basicLightingAlgorithm },
+			Workload{ scenes.randomSpheres, &Renderer::basicLightingAlgorithm },
+			Workload{ scenes.manyLights, &Renderer::basicLightingAlgorithm },
+			Workload{ scenes.lotsOfSpheres, &Renderer::allDiffuseAlgorithm }
+		};
+
+		std::vector<unsigned int> threadCounts;
+		const unsigned int hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		for (unsigned int threads = hardwareThreads; threads >= 1 && threadCounts.size() < 4; threads /= 2) {
+			threadCounts.push_back(threads);
+		}
+
+		TuningConfig config{};
+		tune(config, &TuningConfig::threadCount, threadCounts, workloads, settings);
+		tune(config, &TuningConfig::tileSize, { 8u, 16u, 32u, 64u }, workloads, settings);
+		std::vector<Workload> refitWorkloads = workloads;
+		for (Workload& workload : refitWorkloads) {
+			workload.scene = withBinaryBVH(workload.scene);
+		}
+		tune(config, &TuningConfig::traversal, { SphereTraversal::WIDE_BVH, SphereTraversal::BINARY_BVH }, refitWorkloads, settings);
+		tune(config, &TuningConfig::raySortThreshold, { 0u, 256u, 1024u, 4096u }, { workloads.back() }, settings);
+		return config;
+	}
+
+	std::optional<TuningConfig> loadTuning(const std::filesystem::path& path, const MachineKey& machine) {
+		std::ifstream file{ path };
+		std::string line;
+		while (std::getline(file, line)) {
+			// model \t hardware threads \t tile size \t threads \t traversal \t ray sort threshold
+			std::istringstream fields{ line };
+			std::string model, hardwareThreads, tileSize, threadCount, traversal, raySortThreshold;
+			if (line.empty() || line[0] == '#' || !std::getline(fields, model, '\t') || !std::getline(fields, hardwareThreads, '\t')
+				|| !std::getline(fields, tileSize, '\t') || !std::getline(fields, threadCount, '\t') || !std::getline(fields, traversal, '\t')
+				|| !std::getline(fields, raySortThreshold)) {
+				continue;
+			}
+
+			if (model != machine.cpuModel || hardwareThreads != std::to_string(machine.hardwareThreads)) {
+				continue;
+			}
+
+			try {
+				TuningConfig config{};
+				config.tileSize = std::max(static_cast<unsigned int>(std::stoul(tileSize)), 1u);
+				config.threadCount = static_cast<unsigned int>(std::stoul(threadCount));
+				config.traversal = traversal == traversalName(SphereTraversal::BINARY_BVH) ? SphereTraversal::BINARY_BVH : SphereTraversal::WIDE_BVH;
+				config.raySortThreshold = static_cast<unsigned int>(std::stoul(raySortThreshold));
+				return config;
+			}
+			catch (const std::exception&) {
+				return std::nullopt;
+			}
+		}
+		return std::nullopt;
+	}
+
+	bool saveTuning(const std::filesystem::path& path, const MachineKey& machine, const TuningConfig& config) {
+		// Other machines' lines are kept, this machine's is replaced
+		std::vector<std::string> lines;
+		{
+			std::ifstream file{ path };
+			const std::string prefix = machine.cpuModel + '\t' + std::to_string(machine.hardwareThreads) + '\t';
+			std::string line;
+			while (std::getline(file, line)) {
+				if (!line.empty() && line[0] != '#' && line.compare(0, prefix.size(), prefix) != 0) {
+					lines.push_back(line);
+				}
+			}
+		}
+
+		std::ostringstream entry;
+		entry << machine.cpuModel << '\t' << machine.hardwareThreads << '\t' << config.tileSize << '\t' << config.threadCount << '\t'
+			<< traversalName(config.traversal) << '\t' << config.raySortThreshold;
+		lines.push_back(entry.str());
+
+		std::ofstream file{ path, std::ios::trunc };
+		file << "# Rhodochrosite autotune: cpu model, hardware threads, tile size, threads, sphere traversal, ray sort threshold\n";
+		for (const std::string& line : lines) {
+			file << line << '\n';
+		}
+		return static_cast<bool>(file);
+	}
+
+	void applyTuning(const TuningConfig& config, Renderer& renderer) {
+		renderer.setTileSize(config.tileSize);
+		renderer.setSphereTraversal(config.traversal);
+		renderer.setRaySortThreshold(config.raySortThreshold);
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "Renderer.h"
+
+namespace Rhodochrosite {
+	class Scenes;
+
+	struct TuningConfig {
+		unsigned int tileSize{ 32 };
+		unsigned int threadCount{ 0 }; // 0 for one per hardware thread
+		SphereTraversal traversal{ SphereTraversal::WIDE_BVH };
+		unsigned int raySortThreshold{ 0 };
+	};
+
+	// What a tuning is valid for, the same binary on another CPU or core count tunes again
+	struct MachineKey {
+		std::string cpuModel;
+		unsigned int hardwareThreads{ 0 };
+
+		[[nodiscard]] static MachineKey current();
+	};
+
+	struct AutotuneSettings {
+		unsigned int width{ 256 };
+		unsigned int height{ 144 };
+		unsigned int repeats{ 2 }; // Best of, to stay clear of one off stalls
+	};
+
+	// Times short renders of representative scenes and picks each setting in turn, keeping the ones before it
+	// fixed: thread count, tile size, sphere traversal and then the ray sort threshold. Takes a few seconds.
+	[[nodiscard]] TuningConfig autotune(const Scenes& scenes, const AutotuneSettings& settings = {});
+
+	// The cache is a text file with a line per machine, so one file can serve a whole farm
+	[[nodiscard]] std::optional<TuningConfig> loadTuning(const std::filesystem::path& path, const MachineKey& machine);
+	bool saveTuning(const std::filesystem::path& path, const MachineKey& machine, const TuningConfig& config);
+
+	// Everything but the thread count, which belongs to the pool the renderer was given
+	void applyTuning(const TuningConfig& config, Renderer& renderer);
+}
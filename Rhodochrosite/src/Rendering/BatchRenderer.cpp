@@ -0,0 +1,49 @@
+#include "BatchRenderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+namespace Rhodochrosite {
+	BatchRenderer::BatchRenderer(ThreadPool& pool)
+		: m_Pool(pool) { }
+
+	BatchStats BatchRenderer::render(const SceneSnapshot& scene, const std::vector<RenderView>& views) {
+		const auto start = std::chrono::steady_clock::now();
+
+		// Renderers are kept between batches when the resolution allows it
+		m_Views.resize(views.size());
+		for (size_t i = 0; i < views.size(); i++) {
+			std::unique_ptr<View>& view = m_Views[i];
+			if (view == nullptr || view->renderer.getImage().getWidth() != views[i].width || view->renderer.getImage().getHeight() != views[i].height) {
+				view = std::make_unique<View>(views[i].width, views[i].height, m_Pool);
+			}
+
+			view->camera = views[i].camera;
+			view->renderer.setScene(views[i].scene != nullptr ? views[i].scene : scene);
+			view->renderer.setAlgorithm(views[i].algorithm);
+			view->renderer.setSampler(m_Sampler);
+			view->renderer.setSamplesPerPixel(m_SamplesPerPixel);
+			view->renderer.setTileSize(m_TileSize);
+		}
+
+		// Largest views first, the small ones then fill in the threads the large ones leave idle near their end
+		std::vector<size_t> order(views.size());
+		std::iota(order.begin(), order.end(), size_t{ 0 });
+		std::stable_sort(order.begin(), order.end(), [&](const size_t a, const size_t b) {
+			return static_cast<std::uint64_t>(views[a].width) * views[a].height > static_cast<std::uint64_t>(views[b].width) * views[b].height;
+		});
+
+		BatchStats stats{};
+		for (const size_t view : order) {
+			m_Views[view]->renderer.beginRender();
+			stats.pixels += static_cast<std::uint64_t>(views[view].width) * views[view].height;
+		}
+		for (const size_t view : order) {
+			m_Views[view]->renderer.waitForRender();
+		}
+
+		stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return stats;
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Camera.h"
+#include "Renderer.h"
+
+namespace Rhodochrosite {
+	struct RenderView {
+		Ruby::Camera camera{};
+		unsigned int width{ 256 };
+		unsigned int height{ 256 };
+		Renderer::PerPixelAlgorithm algorithm{ &Renderer::basicLightingAlgorithm };
+		SceneSnapshot scene{ nullptr }; // Overrides the batch's scene for this view
+	};
+
+	struct BatchStats {
+		double seconds{ 0.0 };
+		std::uint64_t pixels{ 0 };
+	};
+
+	// Renders many views at once. Every view's tiles go onto one pool before any view is waited for, so views
+	// too small to occupy every thread run alongside each other instead of one after another. Views share the
+	// scene snapshot, and with it its BVH and light tree.
+	class BatchRenderer {
+	public:
+		explicit BatchRenderer(ThreadPool& pool = ThreadPool::shared());
+
+		BatchRenderer(const BatchRenderer& other) = delete;
+		BatchRenderer& operator=(const BatchRenderer& other) = delete;
+
+		// Blocks until every view is rendered, view i ends up in getImage(i)
+		BatchStats render(const SceneSnapshot& scene, const std::vector<RenderView>& views);
+
+		[[nodiscard]] size_t getViewCount() const { return m_Views.size(); }
+		[[nodiscard]] Ruby::Image& getImage(const size_t view) { return m_Views[view]->renderer.getImage(); }
+
+		// Take effect from the next batch
+		void setTileSize(const unsigned int tileSize) { m_TileSize = tileSize == 0 ? 1 : tileSize; }
+		void setSampler(std::shared_ptr<const Sampler> sampler) { m_Sampler = std::move(sampler); }
+		void setSamplesPerPixel(const unsigned int samplesPerPixel) { m_SamplesPerPixel = samplesPerPixel == 0 ? 1 : samplesPerPixel; }
+
+	private:
+		// Renderers keep a reference to their camera, so each view lives at a fixed address
+		struct View {
+			View(unsigned int width, unsigned int height, ThreadPool& pool)
+				: renderer(width, height, camera, pool) { }
+
+			Ruby::Camera camera{};
+			Renderer renderer;
+		};
+
+		ThreadPool& m_Pool;
+		std::vector<std::unique_ptr<View>> m_Views;
+
+		unsigned int m_TileSize{ 16 }; // Thumbnails are small, smaller tiles leave fewer threads idle at the end
+		std::shared_ptr<const Sampler> m_Sampler{ nullptr };
+		unsigned int m_SamplesPerPixel{ 1 };
+	};
+}
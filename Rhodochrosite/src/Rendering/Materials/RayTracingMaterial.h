@@ -1,5 +1,7 @@
 #pragma once
+#include "Scene.h"
 #include "Sphere.h"
+#include "SceneBuffer.h"
 
 #include "Materials/Material.h"
 
@@ -17,6 +19,7 @@ namespace Rhodochrosite {
 		void use(const Malachite::Matrix4f& model, const Malachite::Matrix4f& view, const Malachite::Matrix4f& projection) override {
 			m_Program->use();
 			m_Uniforms.upload();
+			m_SceneBuffer.bind(scene);
 		}
 
 		static inline Malachite::Vector3f cameraPosition{ 0.0f };
@@ -27,9 +30,7 @@ namespace Rhodochrosite {
 			   
 		static inline float time{ 0.0f };
 			  
-		static inline std::vector<Sphere> spheres{ };
-			   
-		static inline std::vector<Ruby::DirectionalLight> dirLights{ };
+		static inline SceneSnapshot scene{ };
 
 	private:
 		Ruby::UniformSet<
@@ -38,9 +39,7 @@ namespace Rhodochrosite {
 			float,				 // Aspect ration
 			int,				 // Pixel Width
 			int,				 // Pixel Height
-			float,				 // Time
-			std::vector<Sphere>, // Spheres
-			std::vector<Ruby::DirectionalLight> // Directional Lights
+			float				 // Time
 		> m_Uniforms{
 			Ruby::Uniform{"cameraPosition", cameraPosition},
 			Ruby::Uniform{"cameraDirection", cameraDirection},
@@ -48,36 +47,9 @@ namespace Rhodochrosite {
 			Ruby::Uniform{"pixelWidth", pixelWidth},
 			Ruby::Uniform{"pixelHeight", pixelHeight},
 			Ruby::Uniform{"time", time},
-			Ruby::Uniform{"spheres", spheres},
-			Ruby::Uniform{"dirLights", dirLights},
 		};
+
+		// Spheres, planes, discs and directional lights, only uploaded when scene changes
+		SceneBuffer m_SceneBuffer;
 	};
 }
-
-namespace ShaderProgramUploads {
-	inline void upload(const std::string& variableName, const Rhodochrosite::Sphere& sphere) {
-		Ruby::ShaderProgram::upload(variableName + ".origin", sphere.origin);
-		Ruby::ShaderProgram::upload(variableName + ".radius", sphere.radius);
-		Ruby::ShaderProgram::upload(variableName + ".colour", sphere.colour.colour);
-		switch (sphere.material) {
-		case Rhodochrosite::Material::REFLECTION:
-			Ruby::ShaderProgram::upload(variableName + ".material", 1);
-			break;
-		case Rhodochrosite::Material::REFRACTION:
-			Ruby::ShaderProgram::upload(variableName + ".material", 2);
-			break;
-		case Rhodochrosite::Material::DIFFUSE:
-			Ruby::ShaderProgram::upload(variableName + ".material", 0);
-			break;
-		}
-	}
-
-	inline void upload(const std::string& variableName, const std::vector<Rhodochrosite::Sphere>& spheres) {
-		Ruby::ShaderProgram::upload("numberOfSpheres", (int)spheres.size());
-		unsigned int i{ 0 };
-		for (Rhodochrosite::Sphere sphere : spheres) {
-			upload(variableName + "[" + std::to_string(i) + "]", sphere);
-			i++;
-		}
-	}
-}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#include "SceneBuffer.h"
+
+#include <GL/glew.h>
+
+namespace Rhodochrosite {
+	SceneBuffer::~SceneBuffer() {
+		if (m_Buffer != 0) {
+			glDeleteBuffers(1, &m_Buffer);
+		}
+	}
+
+	void SceneBuffer::bind(const SceneSnapshot& scene) {
+		if (m_Buffer == 0) {
+			GLint alignment{ 0 };
+			glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+			m_Packer = std::make_unique<ScenePacker>(static_cast<size_t>(alignment));
+			glGenBuffers(1, &m_Buffer);
+		}
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_Buffer);
+		if (m_Packer->update(scene)) {
+			const std::vector<unsigned char>& bytes = m_Packer->getPacked().bytes;
+			if (bytes.size() > m_Capacity) {
+				m_Capacity = bytes.size();
+				glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(m_Capacity), bytes.data(), GL_DYNAMIC_DRAW);
+			}
+			else {
+				glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(bytes.size()), bytes.data());
+			}
+		}
+
+		const PackedScene& packed = m_Packer->getPacked();
+		const PackedScene::Section sections[]{ packed.spheres, packed.planes, packed.discs, packed.directionalLights };
+		for (GLuint i = 0; i < 4; i++) {
+			glBindBufferRange(GL_SHADER_STORAGE_BUFFER, sceneBufferFirstBinding + i, m_Buffer, static_cast<GLintptr>(sections[i].offset), static_cast<GLsizeiptr>(sections[i].size));
+		}
+	}
+}
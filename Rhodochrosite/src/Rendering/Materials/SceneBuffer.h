@@ -0,0 +1,27 @@
+#pragma once
+
+#include <memory>
+
+#include "Rendering/ScenePacking.h"
+
+namespace Rhodochrosite {
+	// Shader storage buffer holding a packed scene. Created on first use, so it can be constructed before there is a context.
+	class SceneBuffer {
+	public:
+		SceneBuffer() = default;
+		~SceneBuffer();
+
+		SceneBuffer(const SceneBuffer& other) = delete;
+		SceneBuffer& operator=(const SceneBuffer& other) = delete;
+
+		// Uploads scene if it is not the snapshot uploaded last, then binds its sections to the scene's binding points
+		void bind(const SceneSnapshot& scene);
+
+		[[nodiscard]] unsigned int getUploadCount() const { return m_Packer ? m_Packer->getPackCount() : 0; }
+
+	private:
+		unsigned int m_Buffer{ 0 };
+		size_t m_Capacity{ 0 };
+		std::unique_ptr<ScenePacker> m_Packer; // Needs the context's offset alignment
+	};
+}
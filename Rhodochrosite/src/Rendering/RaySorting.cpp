@@ -0,0 +1,59 @@
+#include "RaySorting.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace Rhodochrosite {
+	namespace {
+		constexpr unsigned int cellsPerAxis = 512;
+
+		// Spreads the low 9 bits of value out to every third bit
+		std::uint32_t spreadBits(std::uint32_t value) {
+			value &= cellsPerAxis - 1;
+			value = (value | (value << 16)) & 0x030000ffu;
+			value = (value | (value << 8)) & 0x0300f00fu;
+			value = (value | (value << 4)) & 0x030c30c3u;
+			value = (value | (value << 2)) & 0x09249249u;
+			return value;
+		}
+
+		std::uint32_t quantize(const float value, const float min, const float cellsPerUnit) {
+			const float cell = (value - min) * cellsPerUnit;
+			return cell <= 0.0f ? 0u : std::min(static_cast<std::uint32_t>(cell), cellsPerAxis - 1);
+		}
+	}
+
+	std::uint32_t rayKey(const Ray& ray, const Malachite::Vector3f& boundsMin, const Malachite::Vector3f& cellsPerUnit) {
+		const std::uint32_t octant = (ray.direction.x < 0.0f ? 1u : 0u) | (ray.direction.y < 0.0f ? 2u : 0u) | (ray.direction.z < 0.0f ? 4u : 0u);
+
+		const std::uint32_t morton = spreadBits(quantize(ray.origin.x, boundsMin.x, cellsPerUnit.x))
+			| (spreadBits(quantize(ray.origin.y, boundsMin.y, cellsPerUnit.y)) << 1)
+			| (spreadBits(quantize(ray.origin.z, boundsMin.z, cellsPerUnit.z)) << 2);
+
+		return (octant << 27) | morton;
+	}
+
+	void sortRays(const std::vector<Ray>& rays, std::vector<unsigned int>& order, std::vector<std::uint64_t>& keys) {
+		Malachite::Vector3f boundsMin{ std::numeric_limits<float>::max() };
+		Malachite::Vector3f boundsMax{ -std::numeric_limits<float>::max() };
+		for (const unsigned int index : order) {
+			const Malachite::Vector3f& origin = rays[index].origin;
+			boundsMin = Malachite::Vector3f{ std::min(boundsMin.x, origin.x), std::min(boundsMin.y, origin.y), std::min(boundsMin.z, origin.z) };
+			boundsMax = Malachite::Vector3f{ std::max(boundsMax.x, origin.x), std::max(boundsMax.y, origin.y), std::max(boundsMax.z, origin.z) };
+		}
+
+		const auto cellsPerUnit = [](const float extent) { return extent > 0.0f ? static_cast<float>(cellsPerAxis) / extent : 0.0f; };
+		const Malachite::Vector3f scale{ cellsPerUnit(boundsMax.x - boundsMin.x), cellsPerUnit(boundsMax.y - boundsMin.y), cellsPerUnit(boundsMax.z - boundsMin.z) };
+
+		// The index rides along in the low bits, so sorting plain integers sorts the rays
+		keys.clear();
+		for (const unsigned int index : order) {
+			keys.push_back((static_cast<std::uint64_t>(rayKey(rays[index], boundsMin, scale)) << 32) | index);
+		}
+		std::sort(keys.begin(), keys.end());
+
+		for (size_t i = 0; i < keys.size(); i++) {
+			order[i] = static_cast<unsigned int>(keys[i] & 0xffffffffu);
+		}
+	}
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Ray.h"
+
+namespace Rhodochrosite {
+	// 3 bits of direction octant above a 27 bit Morton code of the origin's position within the batch's bounds,
+	// 9 bits per axis, so rays that start close together and head the same way end up next to each other
+	[[nodiscard]] std::uint32_t rayKey(const Ray& ray, const Malachite::Vector3f& boundsMin, const Malachite::Vector3f& cellsPerUnit);
+
+	// Reorders the indices in order (into rays) by rayKey, keys is scratch space kept between calls
+	void sortRays(const std::vector<Ray>& rays, std::vector<unsigned int>& order, std::vector<std::uint64_t>& keys);
+}
@@ -1,239 +1,953 @@
 #include "Renderer.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
 #include <vector>
 
 #include "Random.h"
 #include "Ray.h"
+#include "RaySorting.h"
 #include "Utility.h"
+#include "Threading/BlockingQueue.h"
 
 namespace Rhodochrosite {
-	Renderer::Renderer(const unsigned int width, const unsigned int height, Ruby::Camera& camera)
+	namespace {
+		// Tiles render on several threads at once, so every thread draws from its own generator
+		std::mt19937& threadGenerator() {
+			thread_local std::mt19937 generator{ std::random_device{}() };
+			return generator;
+		}
+
+		float randomFloat() {
+			return std::uniform_real_distribution<float>{ 0.0f, 1.0f }(threadGenerator());
+		}
+
+		// Pixel sample the calling thread is rendering, set by renderRect so the per pixel algorithms can
+		// draw their numbers from the renderer's sampler
+		struct PixelSample {
+			const Sampler* sampler{ nullptr };
+			unsigned int x{ 0 };
+			unsigned int y{ 0 };
+			unsigned int index{ 0 };
+
+			[[nodiscard]] float get(const unsigned int dimension) const {
+				// Algorithms called outside of a frame have no sampler
+				return sampler == nullptr ? randomFloat() : sampler->get(x, y, index, dimension);
+			}
+		};
+		thread_local PixelSample pixelSample;
+
+		// Dimensions 0 and 1 jitter the pixel. Every diffuse bounce starts a group of four so its three numbers
+		// come from the same Sobol point, light choices only happen without bounces and fill the space between.
+		constexpr unsigned int lightDimension = 2;
+		constexpr unsigned int bounceDimension(const unsigned int bounce) {
+			return 4 + 4 * bounce;
+		}
+	}
+
+	namespace {
+		constexpr unsigned int diffuseBounces = 10;
+		const Malachite::Vector3f diffuseBackground{ 0.203f, 0.596f, 0.922f };
+
+		Ray scatterDiffuse(const Ray& ray, const Renderer::Hit& hit, const float u1, const float u2, const float u3) {
+			const Malachite::Vector3f hitPosition = ray.at(hit.distanceToHit);
+			return Ray{ hitPosition + hit.normal * 0.001f, Malachite::reflect(ray.direction, hit.normal + sampleUnitBall(u1, u2, u3)) };
+		}
+	}
+
+	Renderer::Renderer(const unsigned int width, const unsigned int height, Ruby::Camera& camera, ThreadPool& pool)
 		: m_RenderImage(Malachite::Vector4f{1.0f}, width, height)
 		, m_Width(width)
 		, m_Height(height)
 		, m_Camera(camera)
+		, m_FrameCamera(camera)
+		, m_Pool(pool)
+		, m_Sampler(std::make_shared<RandomSampler>())
 		, m_PerPixelAlgorithm(&Renderer::basicLightingAlgorithm) { }
 
+	Renderer::~Renderer() {
+		cancelRender();
+	}
+
 	void Renderer::render() {
-		std::vector<unsigned char>& content = m_RenderImage.getContent();
-		for (unsigned int y = 0; y < m_Height; y++) {
-			for (unsigned int x = 0; x < m_Width; x++) {
-				Malachite::Vector2f cord = {static_cast<float>(x) / static_cast<float>(m_Width), static_cast<float>(y) / static_cast<float>(m_Height)};
-				cord.x = cord.x * 2.0f - 1.0f;
-				cord.y = (cord.y * 2.0f - 1.0f) * (static_cast<float>(m_Height) / static_cast<float>(m_Width));
+		beginRender();
+		waitForRender();
+	}
 
-				Ruby::Colour pixelColour = (this->*m_PerPixelAlgorithm)(cord);
+	void Renderer::beginRender() {
+		cancelRender();
 
-				const Malachite::Vector4uc colourData = pixelColour.toVec4();
+		// The last frame only becomes the history if every one of its pixels was rendered
+		const bool lastFrameComplete = !m_Tiles.empty() && m_PassTilesDone[m_FramePasses - 1].load(std::memory_order_relaxed) == m_Tiles.size();
+		beginTemporalFrame(lastFrameComplete);
 
-				content[(x + y * m_Width) * 4 + 0] = colourData.x;
-				content[(x + y * m_Width) * 4 + 1] = colourData.y;
-				content[(x + y * m_Width) * 4 + 2] = colourData.z;
-				content[(x + y * m_Width) * 4 + 3] = colourData.w;
+		// Gap filling stays inside a tile when tiles are made of whole blocks of the first pass
+		const unsigned int tileSize = m_ProgressivePreview ? (m_TileSize + previewStride - 1) / previewStride * previewStride : m_TileSize;
+		m_FramePasses = m_ProgressivePreview ? previewPasses : 1;
+
+		m_Tiles.clear();
+		for (unsigned int y = 0; y < m_Height; y += tileSize) {
+			for (unsigned int x = 0; x < m_Width; x += tileSize) {
+				m_Tiles.emplace_back(Tile{ x, y, std::min(tileSize, m_Width - x), std::min(tileSize, m_Height - y) });
 			}
 		}
+
+		// Nothing is rendering, so no worker can be touching the nodes or counters
+		m_CompletedTiles.store(nullptr, std::memory_order_relaxed);
+		m_CompletedTileNodes.resize(m_Tiles.size() * m_FramePasses);
+		m_NextTile.store(0, std::memory_order_relaxed);
+		m_TilePassesDone = std::make_unique<std::atomic<unsigned int>[]>(m_Tiles.size());
+		m_TileHolds = std::make_unique<std::atomic<TileHold>[]>(m_Tiles.size());
+		m_HeldTiles.clear();
+		for (std::atomic<unsigned int>& tilesDone : m_PassTilesDone) {
+			tilesDone.store(0, std::memory_order_relaxed);
+		}
+
+		const unsigned int workers = std::min(m_Pool.getThreadCount(), static_cast<unsigned int>(m_Tiles.size()));
+		for (unsigned int i = 0; i < workers; i++) {
+			m_Frame.run(m_Pool, [this]() { renderTiles(); });
+		}
 	}
 
-	void Renderer::setScene(const Scene& scene) {
-		m_Scene = scene;
+	void Renderer::cancelRender() {
+		m_Cancelled = true;
+		m_Frame.wait();
+		m_Cancelled = false;
 	}
 
-	void Renderer::setAlgorithm(Ruby::Colour (Renderer::* algorithm)(const Malachite::Vector2f& texCords) const) {
-		m_PerPixelAlgorithm = algorithm;
+	void Renderer::waitForRender() {
+		releaseCompletedTiles();
+		m_Frame.wait();
 	}
 
-	constexpr float infinity = std::numeric_limits<float>::max();
+	bool Renderer::isRenderComplete() {
+		return m_Frame.isDone();
+	}
 
-	Renderer::Hit Renderer::hitSpheres(const Ray& ray) const {
-		Hit hit{};
-		for (unsigned int i = 0; i < m_Scene.spheres.size(); i++) {
-			// Discriminant calculations
-			const float a = dot(ray.direction, ray.direction);
-			const float b = 2.0f * dot(ray.origin - m_Scene.spheres[i].origin, ray.direction);
-			const float c = dot(ray.origin - m_Scene.spheres[i].origin, ray.origin - m_Scene.spheres[i].origin) - (m_Scene.spheres[i].radius * m_Scene.spheres[i].radius);
-
-			const float discriminant = b * b - 4.0f * a * c;
-			if (discriminant < 0.0f) {
-				continue;
+	void Renderer::takeCompletedTiles(std::vector<Tile>& tiles) {
+		releaseCompletedTiles();
+
+		const CompletedTile* node = m_CompletedTiles.exchange(nullptr, std::memory_order_acquire);
+		while (node != nullptr) {
+			// A tile already taken from a later pass, or being written by one, is handed out by that pass instead
+			const auto tileIndex = static_cast<unsigned int>((node - m_CompletedTileNodes.data()) % m_Tiles.size());
+			TileHold expected = TileHold::FREE;
+			if (m_TileHolds[tileIndex].compare_exchange_strong(expected, TileHold::HELD, std::memory_order_acquire, std::memory_order_relaxed)) {
+				tiles.push_back(node->tile);
+				m_HeldTiles.push_back(tileIndex);
 			}
+			node = node->next;
+		}
+	}
 
-			// Solving the quadratic formula
-			const float hitDistance = (-b - std::sqrt(discriminant)) / 2.0f * a;
-			if (hitDistance < 0.0f) {
-				continue;
+	void Renderer::releaseCompletedTiles() {
+		for (const unsigned int tileIndex : m_HeldTiles) {
+			m_TileHolds[tileIndex].store(TileHold::FREE, std::memory_order_release);
+		}
+		m_HeldTiles.clear();
+	}
+
+	unsigned int Renderer::getCompletedPasses() const {
+		unsigned int passes = 0;
+		while (passes < m_FramePasses && m_PassTilesDone[passes].load(std::memory_order_acquire) == m_Tiles.size()) {
+			passes++;
+		}
+		return passes;
+	}
+
+	void Renderer::renderTiles() {
+		unsigned char* content = m_RenderImage.getContent().data();
+		const auto pitch = static_cast<std::ptrdiff_t>(m_Width) * 4;
+		const auto tileCount = static_cast<unsigned int>(m_Tiles.size());
+		std::vector<unsigned char> scratch;
+
+		while (!m_Cancelled.load(std::memory_order_relaxed)) {
+			const unsigned int index = m_NextTile.fetch_add(1, std::memory_order_relaxed);
+			if (index >= tileCount * m_FramePasses) {
+				return;
+			}
+
+			const unsigned int pass = index / tileCount;
+			const unsigned int tileIndex = index % tileCount;
+
+			// The tile's previous pass was handed out before this one, so it is already being rendered
+			std::atomic<unsigned int>& tilePassesDone = m_TilePassesDone[tileIndex];
+			while (tilePassesDone.load(std::memory_order_acquire) < pass) {
+				if (m_Cancelled.load(std::memory_order_relaxed)) {
+					return;
+				}
+				std::this_thread::yield();
+			}
+
+			const Tile& tile = m_Tiles[tileIndex];
+			const PixelLattice lattice = passLattice(pass);
+			unsigned char* tilePixels = content + (tile.x + tile.y * static_cast<size_t>(m_Width)) * 4;
+
+			// Once published the tile's pixels may be being read, so later passes start from a copy of them
+			unsigned char* destination = tilePixels;
+			std::ptrdiff_t destinationPitch = pitch;
+			const size_t rowBytes = static_cast<size_t>(tile.width) * 4;
+			if (pass > 0) {
+				scratch.resize(rowBytes * tile.height);
+				for (unsigned int row = 0; row < tile.height; row++) {
+					std::memcpy(scratch.data() + row * rowBytes, tilePixels + static_cast<std::ptrdiff_t>(row) * pitch, rowBytes);
+				}
+				destination = scratch.data();
+				destinationPitch = static_cast<std::ptrdiff_t>(rowBytes);
 			}
 
-			if (hitDistance < hit.distanceToHit) {
-				hit.distanceToHit = hitDistance;
-				hit.hitSphere = &m_Scene.spheres[i];
+			if (m_FrameTemporal) {
+				renderTemporalRect(tile, destination, destinationPitch, lattice);
+			}
+			else {
+				renderRect(tile, m_Width, m_Height, destination, destinationPitch, PixelFormat::RGBA8, lattice);
 			}
+			fillLatticeGaps(tile, destination, destinationPitch, lattice);
+
+			if (pass > 0) {
+				std::atomic<TileHold>& hold = m_TileHolds[tileIndex];
+				TileHold expected = TileHold::FREE;
+				while (!hold.compare_exchange_weak(expected, TileHold::WRITING, std::memory_order_acquire, std::memory_order_relaxed)) {
+					if (m_Cancelled.load(std::memory_order_relaxed)) {
+						return;
+					}
+					expected = TileHold::FREE;
+					std::this_thread::yield();
+				}
+				for (unsigned int row = 0; row < tile.height; row++) {
+					std::memcpy(tilePixels + static_cast<std::ptrdiff_t>(row) * pitch, scratch.data() + row * rowBytes, rowBytes);
+				}
+				hold.store(TileHold::FREE, std::memory_order_release);
+			}
+
+			tilePassesDone.store(pass + 1, std::memory_order_release);
+			m_PassTilesDone[pass].fetch_add(1, std::memory_order_release);
+			publishTile(index);
 		}
+	}
 
-		return hit;
+	void Renderer::publishTile(const unsigned int index) {
+		CompletedTile* node = &m_CompletedTileNodes[index];
+		node->tile = m_Tiles[index % m_Tiles.size()];
+		node->next = m_CompletedTiles.load(std::memory_order_relaxed);
+		while (!m_CompletedTiles.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) { }
 	}
 
-	[[nodiscard]] Ruby::Colour Renderer::basicLightingAlgorithm(const Malachite::Vector2f& texCords) const {
-		Ray ray{ Malachite::Vector3f::zero, Malachite::Vector3f{texCords.x, texCords.y, -1.f}.normalize() };
+	PixelLattice Renderer::passLattice(const unsigned int pass) const {
+		if (m_FramePasses == 1) {
+			return PixelLattice{};
+		}
+		return PixelLattice{ previewStride >> pass, pass == 0 };
+	}
 
-		const Hit hit = hitSpheres(ray);
-		
-		if (hit.hitSphere == nullptr) {
-			// Miss
-			return Ruby::Colour::black;
+	bool PixelLattice::contains(const unsigned int x, const unsigned int y) const {
+		if (x % stride != 0 || y % stride != 0) {
+			return false;
 		}
-		
-		// Hit
-		const Malachite::Vector3f hitPosition = ray.at(hit.distanceToHit);
-		
-		// Lighting Calculations
-		Malachite::Vector3f normal = hitPosition - hit.hitSphere->origin;
-		normal = normal.normalize();
-		
-		float lightIntensity{ 0.0f };
-		for (unsigned int i = 0; i < m_Scene.lights.size(); i++) {
-			lightIntensity += Malachite::max(dot(normal, -m_Scene.lights[i].direction), 0.0f);
+		return coarsest || x % (stride * 2) != 0 || y % (stride * 2) != 0;
+	}
+
+	void Renderer::fillLatticeGaps(const Tile& rect, unsigned char* destination, const std::ptrdiff_t pitch, const PixelLattice lattice) {
+		if (lattice.stride == 1) {
+			return;
 		}
-		
-		lightIntensity = Malachite::clamp(lightIntensity, 0.0f, 1.0f);
 
-		const Malachite::Vector4f sphereColour = hit.hitSphere->colour.colour * lightIntensity;
-		return Ruby::Colour{sphereColour.x, sphereColour.y, sphereColour.z, 1.0f};
+		// Blocks of pixels done by earlier passes are refilled with the value they already hold
+		for (unsigned int row = 0; row < rect.height; row++) {
+			const unsigned int sourceRow = row - (rect.y + row) % lattice.stride;
+			if (sourceRow >= rect.height) {
+				continue; // The block's pixel is outside the rectangle
+			}
+
+			unsigned char* pixels = destination + static_cast<std::ptrdiff_t>(row) * pitch;
+			const unsigned char* sourcePixels = destination + static_cast<std::ptrdiff_t>(sourceRow) * pitch;
+			for (unsigned int column = 0; column < rect.width; column++) {
+				const unsigned int sourceColumn = column - (rect.x + column) % lattice.stride;
+				if (sourceColumn >= rect.width || (sourceRow == row && sourceColumn == column)) {
+					continue;
+				}
+				std::memcpy(pixels + static_cast<size_t>(column) * 4, sourcePixels + static_cast<size_t>(sourceColumn) * 4, 4);
+			}
+		}
+	}
+
+	bool Renderer::renderStreaming(ScanlineWriter& writer, const StreamingSettings& settings) {
+		struct Band {
+			unsigned int firstRow{ 0 };
+			unsigned int rowCount{ 0 };
+			std::vector<unsigned char> pixels;
+		};
+
+		if (settings.width == 0 || settings.height == 0 || !writer.begin(settings.width, settings.height)) {
+			return false;
+		}
+
+		cancelRender();
+		pinFrame();
+
+		const unsigned int rowsPerBand = settings.rowsPerBand == 0 ? 1 : settings.rowsPerBand;
+		const size_t rowBytes = static_cast<size_t>(settings.width) * 4;
+
+		BlockingQueue<Band> bands{ settings.bandsInFlight };
+		bool written = true;
+
+		std::thread writerThread{ [&]() {
+			while (std::optional<Band> band = bands.pop()) {
+				// Rows are stored bottom up, the writer wants the top row first
+				const unsigned char* topRow = band->pixels.data() + (band->rowCount - 1) * rowBytes;
+				written = writer.writeRows(topRow, band->rowCount, -static_cast<std::ptrdiff_t>(rowBytes)) && written;
+			}
+		} };
+
+		// Bands are produced from the top of the image down
+		for (unsigned int rowsDone = 0; rowsDone < settings.height; rowsDone += rowsPerBand) {
+			Band band{};
+			band.rowCount = std::min(rowsPerBand, settings.height - rowsDone);
+			band.firstRow = settings.height - rowsDone - band.rowCount;
+			band.pixels.resize(band.rowCount * rowBytes);
+
+			// Each band is split into strips rendered in parallel
+			TaskGroup strips{};
+			for (unsigned int y = 0; y < band.rowCount; y += m_TileSize) {
+				strips.run(m_Pool, [&, y]() {
+					const Tile strip{ 0, band.firstRow + y, settings.width, std::min(m_TileSize, band.rowCount - y) };
+					renderRect(strip, settings.width, settings.height, band.pixels.data() + y * rowBytes, static_cast<std::ptrdiff_t>(rowBytes));
+				});
+			}
+			strips.wait();
+
+			bands.push(std::move(band));
+		}
+
+		bands.close();
+		writerThread.join();
+
+		return writer.end() && written;
 	}
 
-	[[nodiscard]] Ruby::Colour Renderer::allReflectiveAlgorithm(const Malachite::Vector2f& texCords) const {
-		const Ray ray{ Malachite::Vector3f::zero, Malachite::Vector3f{texCords.x, texCords.y, -1.f} };
+	bool Renderer::renderInto(const RenderTarget& target, const Tile& rect, const unsigned int width, const unsigned int height) {
+		const auto rowBytes = static_cast<std::ptrdiff_t>(rect.width) * bytesPerPixel(target.format);
+		if (target.pixels == nullptr || rect.width == 0 || rect.height == 0 || rect.x + rect.width > width || rect.y + rect.height > height
+			|| std::abs(target.pitch) < rowBytes) {
+			return false;
+		}
 
-		const Sphere* hitSphere{ nullptr };
-		float closestHit = infinity;
-		for (unsigned int i = 0; i < m_Scene.spheres.size(); i++) {
-			// Discriminant calculations
-			const float a = dot(ray.direction, ray.direction);
-			const float b = 2.0f * dot(ray.origin - m_Scene.spheres[i].origin, ray.direction);
-			const float c = dot(ray.origin - m_Scene.spheres[i].origin, ray.origin - m_Scene.spheres[i].origin) - (m_Scene.spheres[i].radius * m_Scene.spheres[i].radius);
-
-			const float discriminant = b * b - 4.0f * a * c;
-			if (discriminant < 0.0f) {
-				continue;
+		cancelRender();
+		pinFrame();
+
+		// Strips of rows are rendered in parallel, each straight into its part of the caller's memory
+		auto* pixels = static_cast<unsigned char*>(target.pixels);
+		TaskGroup strips{};
+		for (unsigned int y = 0; y < rect.height; y += m_TileSize) {
+			strips.run(m_Pool, [&, y]() {
+				const Tile strip{ rect.x, rect.y + y, rect.width, std::min(m_TileSize, rect.height - y) };
+				renderRect(strip, width, height, pixels + y * target.pitch, target.pitch, target.format);
+			});
+		}
+		strips.wait();
+
+		return true;
+	}
+
+	void Renderer::pinFrame() {
+		m_FrameCamera = m_Camera;
+		m_FrameScene = std::atomic_load(&m_Scene);
+		if (m_FrameScene == nullptr) {
+			m_FrameScene = makeSnapshot(Scene{});
+		}
+
+		// Built once per hierarchy, so snapshots only pay for proxies while a renderer is using them
+		if (m_LODThreshold <= 0.0f || m_FrameScene->wideSphereBVH == nullptr) {
+			m_FrameClusters = nullptr;
+		}
+		else if (m_FrameClusters == nullptr || m_FrameClusters->getBVH() != m_FrameScene->wideSphereBVH) {
+			m_FrameClusters = SphereClusters::build(m_FrameScene->wideSphereBVH, m_FrameScene->spheres, m_Pool);
+		}
+	}
+
+	void Renderer::renderRect(const Tile& rect, const unsigned int width, const unsigned int height, unsigned char* destination, const std::ptrdiff_t pitch, const PixelFormat format, const PixelLattice lattice) const {
+		if (m_PerPixelAlgorithm == &Renderer::allDiffuseAlgorithm) {
+			renderDiffuseRect(rect, width, height, destination, pitch, format, lattice);
+			return;
+		}
+
+		const unsigned int pixelBytes = bytesPerPixel(format);
+		const unsigned int firstRow = (lattice.stride - rect.y % lattice.stride) % lattice.stride;
+		const unsigned int firstColumn = (lattice.stride - rect.x % lattice.stride) % lattice.stride;
+		for (unsigned int row = firstRow; row < rect.height; row += lattice.stride) {
+			const unsigned int y = rect.y + row;
+			for (unsigned int column = firstColumn; column < rect.width; column += lattice.stride) {
+				const unsigned int x = rect.x + column;
+				if (!lattice.contains(x, y)) {
+					continue;
+				}
+
+				Ruby::Colour pixelColour;
+				if (m_SamplesPerPixel == 1) {
+					pixelSample = PixelSample{ m_Sampler.get(), x, y, 0 };
+					pixelColour = (this->*m_PerPixelAlgorithm)(sampleTexCords(x, y, 0, width, height));
+				}
+				else {
+					Malachite::Vector3f sum{ 0.0f };
+					for (unsigned int sample = 0; sample < m_SamplesPerPixel; sample++) {
+						pixelSample = PixelSample{ m_Sampler.get(), x, y, sample };
+						sum += (this->*m_PerPixelAlgorithm)(sampleTexCords(x, y, sample, width, height)).toVec3();
+					}
+					pixelColour = Ruby::Colour{ sum * (1.0f / static_cast<float>(m_SamplesPerPixel)), 1.0f };
+				}
+
+				writePixel(format, pixelColour, destination + row * pitch + static_cast<std::ptrdiff_t>(column) * pixelBytes);
 			}
+		}
+		pixelSample = PixelSample{};
+	}
 
-			// Solving the quadratic formula
-			const float hitDistance = (-b - std::sqrt(discriminant)) / 2.0f * a;
-			if (hitDistance < 0.0f) {
-				continue;
+	void Renderer::renderDiffuseRect(const Tile& rect, const unsigned int width, const unsigned int height, unsigned char* destination, const std::ptrdiff_t pitch, const PixelFormat format, const PixelLattice lattice) const {
+		// Pixels of the rectangle in the lattice, one path each
+		std::vector<unsigned int> pixels;
+		pixels.reserve(static_cast<size_t>(rect.width) * rect.height / (lattice.stride * lattice.stride) + 1);
+		for (unsigned int i = 0; i < rect.width * rect.height; i++) {
+			if (lattice.contains(rect.x + i % rect.width, rect.y + i / rect.width)) {
+				pixels.push_back(i);
+			}
+		}
+		const auto pathCount = static_cast<unsigned int>(pixels.size());
+
+		std::vector<Ray> rays(pathCount);
+		std::vector<Malachite::Vector3f> colours(pathCount, Malachite::Vector3f{ 0.0f });
+		std::vector<float> multipliers(pathCount);
+		std::vector<unsigned int> active(pathCount);
+		std::vector<std::uint64_t> sortKeys;
+
+		// One path per pixel at a time, every sample adds into the same colours
+		std::uint64_t raysTraced = 0;
+		for (unsigned int sample = 0; sample < m_SamplesPerPixel; sample++) {
+			for (unsigned int i = 0; i < pathCount; i++) {
+				rays[i] = primaryRay(sampleTexCords(rect.x + pixels[i] % rect.width, rect.y + pixels[i] / rect.width, sample, width, height));
+				multipliers[i] = 1.0f;
+			}
+			active.resize(pathCount);
+			for (unsigned int i = 0; i < pathCount; i++) {
+				active[i] = i;
 			}
 
-			if (hitDistance < closestHit) {
-				closestHit = hitDistance;
-				hitSphere = &m_Scene.spheres[i];
+			// Same paths as allDiffuseAlgorithm, traced a bounce at a time. Primary rays are already coherent,
+			// after the first bounce they point anywhere and are sorted if there are enough of them to pay for it.
+			for (unsigned int bounce = 0; bounce < diffuseBounces && !active.empty(); bounce++) {
+				if (bounce > 0 && m_RaySortThreshold != 0 && active.size() >= m_RaySortThreshold) {
+					sortRays(rays, active, sortKeys);
+				}
+
+				raysTraced += active.size();
+
+				const unsigned int dimension = bounceDimension(bounce);
+				size_t alive = 0;
+				for (const unsigned int path : active) {
+					const Hit hit = hitScene(rays[path], multipliers[path]);
+					if (!hit.hitSomething()) {
+						colours[path] += diffuseBackground * multipliers[path];
+						continue;
+					}
+
+					colours[path] += hit.colour->toVec3() * multipliers[path];
+					multipliers[path] *= 0.5f;
+
+					const unsigned int x = rect.x + pixels[path] % rect.width;
+					const unsigned int y = rect.y + pixels[path] / rect.width;
+					rays[path] = scatterDiffuse(rays[path], hit,
+						m_Sampler->get(x, y, sample, dimension), m_Sampler->get(x, y, sample, dimension + 1), m_Sampler->get(x, y, sample, dimension + 2));
+					active[alive++] = path;
+				}
+				active.resize(alive);
 			}
 		}
+		m_RaysTraced.fetch_add(raysTraced, std::memory_order_relaxed);
 
-		if (hitSphere == nullptr) {
-			return Ruby::Colour::black;
+		const float sampleWeight = 1.0f / static_cast<float>(m_SamplesPerPixel);
+		const unsigned int pixelBytes = bytesPerPixel(format);
+		for (unsigned int i = 0; i < pathCount; i++) {
+			unsigned char* pixel = destination + static_cast<std::ptrdiff_t>(pixels[i] / rect.width) * pitch + static_cast<std::ptrdiff_t>(pixels[i] % rect.width) * pixelBytes;
+			writePixel(format, Ruby::Colour{ colours[i] * sampleWeight, 1.0f }, pixel);
+		}
+	}
+
+	Malachite::Vector2f Renderer::sampleTexCords(const unsigned int x, const unsigned int y, const unsigned int sample, const unsigned int width, const unsigned int height) const {
+		// A single sample keeps to the pixel's corner so images match those rendered before sampling
+		if (m_SamplesPerPixel == 1) {
+			return pixelToTexCords(x, y, width, height);
 		}
 
-		const Malachite::Vector3f hitPosition = ray.at(closestHit);
+		const Malachite::Vector2f pixel{
+			static_cast<float>(x) + m_Sampler->get(x, y, sample, 0),
+			static_cast<float>(y) + m_Sampler->get(x, y, sample, 1)
+		};
+		return pixelToTexCords(pixel, width, height);
+	}
 
-		// Lighting Calculations
-		Malachite::Vector3f normal = hitPosition - hitSphere->origin;
-		normal = normal.normalize();
+	void Renderer::setSphereTraversal(const SphereTraversal traversal) {
+		cancelRender();
+		m_SphereTraversal = traversal;
+	}
 
-		float lightIntensity{ 0.0f };
-		for (unsigned int i = 0; i < m_Scene.lights.size(); i++) {
-			lightIntensity += Malachite::max(dot(normal, -m_Scene.lights[i].direction), 0.0f);
+	void Renderer::setGeometricLOD(const float throughputThreshold, const float tolerance) {
+		cancelRender();
+		m_LODThreshold = throughputThreshold;
+		m_LODTolerance = tolerance;
+		if (m_LODThreshold <= 0.0f) {
+			m_FrameClusters = nullptr;
 		}
+	}
 
-		lightIntensity = Malachite::clamp(lightIntensity, 0.0f, 1.0f);
+	void Renderer::setTemporalReprojection(const bool enabled) {
+		cancelRender();
+		invalidateTemporalHistory();
+		m_TemporalReprojection = enabled;
+	}
 
-		const Malachite::Vector4f sphereColour = hitSphere->colour.colour * lightIntensity;
-		return Ruby::Colour{ sphereColour.x, sphereColour.y, sphereColour.z, 1.0f };
+	void Renderer::setTemporalHistoryLimit(const unsigned int samples) {
+		cancelRender();
+		m_TemporalHistoryLimit = samples == 0 ? 1 : samples;
 	}
 
-	[[nodiscard]] Ruby::Colour Renderer::allDiffuseAlgorithm(const Malachite::Vector2f& texCords) const {
-		Ray ray{ Malachite::Vector3f::zero, Malachite::Vector3f{texCords.x, texCords.y, -1.f}.normalize() };
-		unsigned int numberOfBounces = 10;
-		Malachite::Vector3f backgroundColour{ 0.203f, 0.596f, 0.922f };
+	Renderer::TemporalStats Renderer::getTemporalStats() const {
+		return TemporalStats{ m_ReprojectedPixels.load(std::memory_order_relaxed), m_ShadedPixels.load(std::memory_order_relaxed) };
+	}
 
-		float multiplier = 1.0f;
-		Malachite::Vector3f colour{ 0.0f };
-		for (unsigned int i = 0; i < numberOfBounces; i++) {
-			const Hit hit = hitSpheres(ray);
+	void Renderer::invalidateTemporalHistory() {
+		// Neither the history nor the last frame, which might still be promoted to it, match what comes next
+		m_TemporalHistoryValid = false;
+		m_FrameTemporal = false;
+		m_HistoryScene = nullptr;
+		m_TemporalFrameScene = nullptr;
+	}
 
-			if (hit.hitSphere == nullptr) {
-				// Miss
-				colour += backgroundColour * multiplier;
-				break;
+	void Renderer::beginTemporalFrame(const bool lastFrameComplete) {
+		if (m_FrameTemporal && lastFrameComplete) {
+			m_HistoryCamera = m_TemporalFrameCamera;
+			m_HistoryScene = std::move(m_TemporalFrameScene);
+			m_TemporalFrame ^= 1;
+			m_TemporalHistoryValid = true;
+		}
+
+		pinFrame();
+
+		m_FrameTemporal = m_TemporalReprojection;
+		m_ReprojectedPixels.store(0, std::memory_order_relaxed);
+		m_ShadedPixels.store(0, std::memory_order_relaxed);
+		if (!m_FrameTemporal) {
+			return;
+		}
+
+		const size_t pixels = static_cast<size_t>(m_Width) * m_Height;
+		for (std::vector<TemporalSample>& history : m_TemporalHistory) {
+			if (history.size() != pixels) {
+				history.assign(pixels, TemporalSample{});
+				m_TemporalHistoryValid = false;
 			}
+		}
 
-			// Hit
-			const Malachite::Vector3f hitPosition = ray.at(hit.distanceToHit);
+		m_TemporalFrameCamera = m_FrameCamera;
+		m_TemporalFrameScene = m_FrameScene;
 
-			// Lighting Calculations
-			Malachite::Vector3f normal = hitPosition - hit.hitSphere->origin;
-			normal = normal.normalize();
+		// Surfaces of a different snapshot may have moved or changed colour
+		if (m_FrameScene != m_HistoryScene) {
+			m_TemporalHistoryValid = false;
+		}
+
+		m_CameraStill = m_TemporalHistoryValid
+			&& m_FrameCamera.position.x == m_HistoryCamera.position.x && m_FrameCamera.position.y == m_HistoryCamera.position.y && m_FrameCamera.position.z == m_HistoryCamera.position.z
+			&& m_FrameCamera.front.x == m_HistoryCamera.front.x && m_FrameCamera.front.y == m_HistoryCamera.front.y && m_FrameCamera.front.z == m_HistoryCamera.front.z;
+	}
 
-			float lightIntensity{ 0.0f };
-			for (unsigned int i = 0; i < m_Scene.lights.size(); i++) {
-				lightIntensity += Malachite::max(dot(normal, -m_Scene.lights[i].direction), 0.0f);
+	void Renderer::renderTemporalRect(const Tile& rect, unsigned char* destination, const std::ptrdiff_t pitch, const PixelLattice lattice) {
+		std::vector<TemporalSample>& history = m_TemporalHistory[m_TemporalFrame];
+		unsigned int reprojected = 0;
+		unsigned int shaded = 0;
+
+		for (unsigned int row = 0; row < rect.height; row++) {
+			const unsigned int y = rect.y + row;
+			for (unsigned int column = 0; column < rect.width; column++) {
+				const unsigned int x = rect.x + column;
+				if (!lattice.contains(x, y)) {
+					continue;
+				}
+
+				// Primary hit at the same place in the pixel as the pixel's first sample
+				const Ray ray = primaryRay(pixelToTexCords(x, y, m_Width, m_Height));
+				const Hit hit = hitScene(ray);
+
+				TemporalSample sample{};
+				if (hit.hitSomething()) {
+					sample.depth = hit.distanceToHit;
+					sample.normal = hit.normal;
+
+					if (const TemporalSample* previous = reprojectHistory(ray.at(hit.distanceToHit), hit.normal)) {
+						sample.radiance = previous->radiance;
+						sample.samples = previous->samples;
+					}
+				}
+
+				// Misses are cheap to shade again, so only hits are reused
+				if (sample.samples == 0 || (m_CameraStill && sample.samples < m_TemporalHistoryLimit)) {
+					Malachite::Vector3f sum{ 0.0f };
+					for (unsigned int i = 0; i < m_SamplesPerPixel; i++) {
+						const unsigned int sampleIndex = sample.samples + i;
+						pixelSample = PixelSample{ m_Sampler.get(), x, y, sampleIndex };
+
+						// Samples accumulate over frames, so even one per frame is jittered to cover the pixel
+						const Malachite::Vector2f position{ static_cast<float>(x) + pixelSample.get(0), static_cast<float>(y) + pixelSample.get(1) };
+						sum += (this->*m_PerPixelAlgorithm)(pixelToTexCords(position, m_Width, m_Height)).toVec3();
+					}
+
+					const unsigned int samples = sample.samples + m_SamplesPerPixel;
+					sample.radiance = (sample.radiance * static_cast<float>(sample.samples) + sum) * (1.0f / static_cast<float>(samples));
+					sample.samples = samples;
+					shaded++;
+				}
+				else {
+					reprojected++;
+				}
+
+				history[static_cast<size_t>(y) * m_Width + x] = sample;
+				writePixel(PixelFormat::RGBA8, Ruby::Colour{ sample.radiance, 1.0f }, destination + static_cast<std::ptrdiff_t>(row) * pitch + static_cast<std::ptrdiff_t>(column) * 4);
 			}
+		}
+		pixelSample = PixelSample{};
 
-			lightIntensity = Malachite::clamp(lightIntensity, 0.0f, 1.0f);
+		m_ReprojectedPixels.fetch_add(reprojected, std::memory_order_relaxed);
+		m_ShadedPixels.fetch_add(shaded, std::memory_order_relaxed);
+	}
 
-			colour += hit.hitSphere->colour.toVec3() * multiplier;
-			multiplier *= 0.5f;
+	const Renderer::TemporalSample* Renderer::reprojectHistory(const Malachite::Vector3f& position, const Malachite::Vector3f& normal) const {
+		if (!m_TemporalHistoryValid) {
+			return nullptr;
+		}
 
-			ray = Ray{ hitPosition + normal * 0.001f, Malachite::reflect(ray.direction, normal + Malachite::randomInUnitSphere<float>()) };
+		Malachite::Vector2f texCords;
+		if (!projectToTexCords(m_HistoryCamera, position, texCords)) {
+			return nullptr;
 		}
 
-		return Ruby::Colour{ colour, 1.0f };
+		// Inverse of pixelToTexCords, rounded to the pixel whose first sample is nearest
+		const float width = static_cast<float>(m_Width);
+		const float height = static_cast<float>(m_Height);
+		const float pixelX = std::round((texCords.x + 1.0f) * 0.5f * width);
+		const float pixelY = std::round((texCords.y * (width / height) + 1.0f) * 0.5f * height);
+		if (pixelX < 0.0f || pixelY < 0.0f || pixelX >= width || pixelY >= height) {
+			return nullptr;
+		}
+
+		const auto x = static_cast<unsigned int>(pixelX);
+		const auto y = static_cast<unsigned int>(pixelY);
+		const TemporalSample& previous = m_TemporalHistory[m_TemporalFrame ^ 1][static_cast<size_t>(y) * m_Width + x];
+		if (previous.samples == 0 || previous.depth == 0.0f) {
+			return nullptr;
+		}
+
+		// Disocclusion: the point has to lie on the surface the pixel saw, and face the same way
+		constexpr float maximumNormalChange = 0.9f; // Cosine
+		constexpr float maximumPlaneDistance = 0.01f; // Fraction of the depth
+		if (dot(previous.normal, normal) < maximumNormalChange) {
+			return nullptr;
+		}
+
+		const Ray previousRay = cameraRay(m_HistoryCamera, pixelToTexCords(x, y, m_Width, m_Height));
+		const Malachite::Vector3f previousPosition = previousRay.at(previous.depth);
+		if (std::abs(dot(position - previousPosition, previous.normal)) > maximumPlaneDistance * previous.depth) {
+			return nullptr;
+		}
+
+		return &previous;
 	}
 
-	[[nodiscard]] Ruby::Colour Renderer::randomMaterialsAlgorithm(const Malachite::Vector2f& texCords) const {
-		const Ray ray{ Malachite::Vector3f::zero, Malachite::Vector3f{texCords.x, texCords.y, -1.f} };
+	SceneSnapshot Renderer::getScene() const {
+		return std::atomic_load(&m_Scene);
+	}
+
+	void Renderer::setScene(SceneSnapshot scene) {
+		std::atomic_store(&m_Scene, std::move(scene));
+	}
+
+	void Renderer::setAlgorithm(const PerPixelAlgorithm algorithm) {
+		// Workers read the algorithm for every pixel
+		cancelRender();
+		invalidateTemporalHistory();
+		m_PerPixelAlgorithm = algorithm;
+	}
+
+	void Renderer::setSampler(std::shared_ptr<const Sampler> sampler) {
+		cancelRender();
+		invalidateTemporalHistory();
+		m_Sampler = sampler == nullptr ? std::make_shared<RandomSampler>() : std::move(sampler);
+	}
+
+	void Renderer::setSamplesPerPixel(const unsigned int samplesPerPixel) {
+		cancelRender();
+		invalidateTemporalHistory();
+		m_SamplesPerPixel = samplesPerPixel == 0 ? 1 : samplesPerPixel;
+	}
+
+	void Renderer::setLightSamples(const unsigned int lightSamples) {
+		cancelRender();
+		m_LightSamples = lightSamples == 0 ? 1 : lightSamples;
+	}
+
+	void Renderer::setRaySortThreshold(const unsigned int threshold) {
+		cancelRender();
+		m_RaySortThreshold = threshold;
+	}
 
+	Renderer::PerPixelAlgorithm Renderer::perPixelAlgorithm(const RenderingAlgorithm algorithm) {
+		switch (algorithm) {
+		default:
+		case RenderingAlgorithm::BASIC_LIGHTING:
+			return &Renderer::basicLightingAlgorithm;
+		case RenderingAlgorithm::ALL_REFLECTIVE:
+			return &Renderer::allReflectiveAlgorithm;
+		case RenderingAlgorithm::ALL_DIFFUSE:
+			return &Renderer::allDiffuseAlgorithm;
+		case RenderingAlgorithm::RANDOM_MATERIALS:
+			return &Renderer::randomMaterialsAlgorithm;
+		}
+	}
+
+	namespace {
+		struct CameraBasis {
+			Malachite::Vector3f front;
+			Malachite::Vector3f right;
+			Malachite::Vector3f up;
+		};
+
+		CameraBasis cameraBasis(const Ruby::Camera& camera) {
+			const Malachite::Vector3f front = camera.front.normalize();
+
+			// Looking straight up or down leaves no horizontal right, the world's forward axis stands in for up
+			Malachite::Vector3f right = cross(front, Malachite::Vector3f::up);
+			if (right.lengthSquared() < 1e-8f) {
+				right = cross(front, Malachite::Vector3f{ 0.0f, 0.0f, -1.0f });
+			}
+			right = right.normalize();
+
+			return CameraBasis{ front, right, cross(right, front) };
+		}
+	}
+
+	Ray Renderer::cameraRay(const Ruby::Camera& camera, const Malachite::Vector2f& texCords) {
+		// Same image plane as the shaders, one unit in front of the camera
+		const auto [front, right, up] = cameraBasis(camera);
+
+		return Ray{ camera.position, (front + right * texCords.x + up * texCords.y).normalize() };
+	}
+
+	Malachite::Vector2f Renderer::pixelToTexCords(const unsigned int x, const unsigned int y, const unsigned int width, const unsigned int height) {
+		return pixelToTexCords(Malachite::Vector2f{ static_cast<float>(x), static_cast<float>(y) }, width, height);
+	}
+
+	Malachite::Vector2f Renderer::pixelToTexCords(const Malachite::Vector2f& pixel, const unsigned int width, const unsigned int height) {
+		Malachite::Vector2f cord = { pixel.x / static_cast<float>(width), pixel.y / static_cast<float>(height) };
+		cord.x = cord.x * 2.0f - 1.0f;
+		cord.y = (cord.y * 2.0f - 1.0f) * (static_cast<float>(height) / static_cast<float>(width));
+		return cord;
+	}
+
+	bool Renderer::projectToTexCords(const Ruby::Camera& camera, const Malachite::Vector3f& point, Malachite::Vector2f& texCords) {
+		const auto [front, right, up] = cameraBasis(camera);
+
+		const Malachite::Vector3f offset = point - camera.position;
+		const float distanceInFront = dot(offset, front);
+		if (distanceInFront <= 0.0f) {
+			return false;
+		}
+
+		texCords = Malachite::Vector2f{ dot(offset, right) / distanceInFront, dot(offset, up) / distanceInFront };
+		return true;
+	}
+
+	Ray Renderer::primaryRay(const Malachite::Vector2f& texCords) const {
+		return cameraRay(m_FrameCamera, texCords);
+	}
+
+	// Hits closer than this are the surface the ray just left
+	constexpr float minimumHitDistance = 0.001f;
+
+	Renderer::Hit Renderer::hitScene(const Ray& ray, const float throughput) const {
+		Hit hit{};
+
+		const std::vector<Sphere>& spheres = m_FrameScene->spheres;
 		const Sphere* hitSphere{ nullptr };
-		float closestHit = infinity;
-		for (unsigned int i = 0; i < m_Scene.spheres.size(); i++) {
-			// Discriminant calculations
-			const float a = dot(ray.direction, ray.direction);
-			const float b = 2.0f * dot(ray.origin - m_Scene.spheres[i].origin, ray.direction);
-			const float c = dot(ray.origin - m_Scene.spheres[i].origin, ray.origin - m_Scene.spheres[i].origin) - (m_Scene.spheres[i].radius * m_Scene.spheres[i].radius);
-
-			const float discriminant = b * b - 4.0f * a * c;
-			if (discriminant < 0.0f) {
+		if (m_FrameClusters != nullptr && throughput < m_LODThreshold) {
+			hitSphere = m_FrameClusters->getBVH()->closestHit(ray, spheres, m_FrameClusters->getProxies(), m_LODTolerance / throughput, hit.distanceToHit);
+		}
+		else if (m_FrameScene->wideSphereBVH != nullptr && (m_SphereTraversal == SphereTraversal::WIDE_BVH || m_FrameScene->sphereBVH == nullptr)) {
+			const unsigned int index = m_FrameScene->wideSphereBVH->closestHit(ray, spheres, hit.distanceToHit);
+			if (index != SphereBVH::noHit) {
+				hitSphere = &spheres[index];
+			}
+		}
+		else if (m_FrameScene->sphereBVH != nullptr) {
+			const unsigned int index = m_FrameScene->sphereBVH->closestHit(ray, spheres, hit.distanceToHit);
+			if (index != SphereBVH::noHit) {
+				hitSphere = &spheres[index];
+			}
+		}
+		else {
+			for (const Sphere& sphere : spheres) {
+				const float hitDistance = ray.hitSphere(sphere);
+				if (hitDistance > 0.0f && hitDistance < hit.distanceToHit) {
+					hit.distanceToHit = hitDistance;
+					hitSphere = &sphere;
+				}
+			}
+		}
+
+		if (hitSphere != nullptr) {
+			hit.colour = &hitSphere->colour;
+			hit.material = hitSphere->material;
+			hit.normal = (ray.at(hit.distanceToHit) - hitSphere->origin).normalize();
+		}
+
+		for (const Plane& plane : m_FrameScene->planes) {
+			const float hitDistance = ray.hitPlane(plane);
+			if (hitDistance < minimumHitDistance || hitDistance >= hit.distanceToHit) {
 				continue;
 			}
 
-			// Solving the quadratic formula
-			const float hitDistance = (-b - std::sqrt(discriminant)) / 2.0f * a;
-			if (hitDistance < 0.0f) {
+			hit.distanceToHit = hitDistance;
+			hit.colour = &plane.colour;
+			hit.material = plane.material;
+			hit.normal = dot(ray.direction, plane.normal) > 0.0f ? -plane.normal : plane.normal;
+		}
+
+		for (const Disc& disc : m_FrameScene->discs) {
+			const float hitDistance = ray.hitDisc(disc);
+			if (hitDistance < minimumHitDistance || hitDistance >= hit.distanceToHit) {
 				continue;
 			}
 
-			if (hitDistance < closestHit) {
-				closestHit = hitDistance;
-				hitSphere = &m_Scene.spheres[i];
+			hit.distanceToHit = hitDistance;
+			hit.colour = &disc.colour;
+			hit.material = disc.material;
+			hit.normal = dot(ray.direction, disc.normal) > 0.0f ? -disc.normal : disc.normal;
+		}
+
+		return hit;
+	}
+
+	float Renderer::directionalLightIntensity(const Malachite::Vector3f& normal) const {
+		float lightIntensity{ 0.0f };
+		for (unsigned int i = 0; i < m_FrameScene->lights.size(); i++) {
+			lightIntensity += Malachite::max(dot(normal, -m_FrameScene->lights[i].direction), 0.0f);
+		}
+
+		return Malachite::clamp(lightIntensity, 0.0f, 1.0f);
+	}
+
+	Malachite::Vector3f Renderer::emitterLight(const Malachite::Vector3f& position, const Malachite::Vector3f& normal) const {
+		const LightTree* tree = m_FrameScene->lightTree.get();
+		if (tree == nullptr) {
+			return Malachite::Vector3f{ 0.0f };
+		}
+
+		// With only a few lights the exact sum is cheaper than sampling
+		Malachite::Vector3f light{ 0.0f };
+		if (tree->getEmitterCount() <= m_LightSamples) {
+			for (unsigned int i = 0; i < tree->getEmitterCount(); i++) {
+				light += tree->getEmitter(i).irradiance(position, normal);
 			}
+			return light;
 		}
 
-		if (hitSphere == nullptr) {
+		for (unsigned int i = 0; i < m_LightSamples; i++) {
+			LightTree::Sample sample;
+			if (tree->sample(position, normal, pixelSample.get(lightDimension + i), sample)) {
+				light += tree->getEmitter(sample.emitter).irradiance(position, normal) * (1.0f / sample.probability);
+			}
+		}
+		return light * (1.0f / static_cast<float>(m_LightSamples));
+	}
+
+	Malachite::Vector4f Renderer::shade(const Ray& ray, const Hit& hit) const {
+		const Malachite::Vector3f position = ray.at(hit.distanceToHit);
+		const Malachite::Vector3f light = emitterLight(position, hit.normal) + Malachite::Vector3f{ directionalLightIntensity(hit.normal) };
+
+		const Malachite::Vector3f surfaceColour = hit.colour->toVec3();
+		return Malachite::Vector4f{
+			Malachite::min(surfaceColour.x * light.x, 1.0f),
+			Malachite::min(surfaceColour.y * light.y, 1.0f),
+			Malachite::min(surfaceColour.z * light.z, 1.0f),
+			1.0f
+		};
+	}
+
+	[[nodiscard]] Ruby::Colour Renderer::basicLightingAlgorithm(const Malachite::Vector2f& texCords) const {
+		Ray ray = primaryRay(texCords);
+
+		const Hit hit = hitScene(ray);
+		
+		if (!hit.hitSomething()) {
+			// Miss
 			return Ruby::Colour::black;
 		}
+		
+		// Lighting Calculations
+		const Malachite::Vector4f surfaceColour = shade(ray, hit);
+		return Ruby::Colour{surfaceColour.x, surfaceColour.y, surfaceColour.z, 1.0f};
+	}
+
+	[[nodiscard]] Ruby::Colour Renderer::allReflectiveAlgorithm(const Malachite::Vector2f& texCords) const {
+		const Ray ray = primaryRay(texCords);
 
-		const Malachite::Vector3f hitPosition = ray.at(closestHit);
+		const Hit hit = hitScene(ray);
+
+		if (!hit.hitSomething()) {
+			return Ruby::Colour::black;
+		}
 
 		// Lighting Calculations
-		Malachite::Vector3f normal = hitPosition - hitSphere->origin;
-		normal = normal.normalize();
+		const Malachite::Vector4f surfaceColour = shade(ray, hit);
+		return Ruby::Colour{ surfaceColour.x, surfaceColour.y, surfaceColour.z, 1.0f };
+	}
 
-		float lightIntensity{ 0.0f };
-		for (unsigned int i = 0; i < m_Scene.lights.size(); i++) {
-			lightIntensity += Malachite::max(dot(normal, -m_Scene.lights[i].direction), 0.0f);
+	[[nodiscard]] Ruby::Colour Renderer::allDiffuseAlgorithm(const Malachite::Vector2f& texCords) const {
+		Ray ray = primaryRay(texCords);
+
+		float multiplier = 1.0f;
+		Malachite::Vector3f colour{ 0.0f };
+		for (unsigned int i = 0; i < diffuseBounces; i++) {
+			const Hit hit = hitScene(ray, multiplier);
+
+			if (!hit.hitSomething()) {
+				// Miss
+				colour += diffuseBackground * multiplier;
+				break;
+			}
+
+			// Hit
+			colour += hit.colour->toVec3() * multiplier;
+			multiplier *= 0.5f;
+
+			const unsigned int dimension = bounceDimension(i);
+			ray = scatterDiffuse(ray, hit, pixelSample.get(dimension), pixelSample.get(dimension + 1), pixelSample.get(dimension + 2));
 		}
 
-		lightIntensity = Malachite::clamp(lightIntensity, 0.0f, 1.0f);
+		return Ruby::Colour{ colour, 1.0f };
+	}
 
-		const Malachite::Vector4f sphereColour = hitSphere->colour.colour * lightIntensity;
-		return Ruby::Colour{ sphereColour.x, sphereColour.y, sphereColour.z, 1.0f };
+	[[nodiscard]] Ruby::Colour Renderer::randomMaterialsAlgorithm(const Malachite::Vector2f& texCords) const {
+		const Ray ray = primaryRay(texCords);
+
+		const Hit hit = hitScene(ray);
+
+		if (!hit.hitSomething()) {
+			return Ruby::Colour::black;
+		}
+
+		// Lighting Calculations
+		const Malachite::Vector4f surfaceColour = shade(ray, hit);
+		return Ruby::Colour{ surfaceColour.x, surfaceColour.y, surfaceColour.z, 1.0f };
 	}
 }
\ No newline at end of file
@@ -1,10 +1,21 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Acceleration/SphereClusters.h"
 #include "Camera.h"
+#include "Output/PixelFormat.h"
+#include "Output/ScanlineWriter.h"
 #include "Resources/Image.h"
 #include "Ray.h"
+#include "Sampling/Sampler.h"
 #include "Scene.h"
 #include "Sphere.h"
+#include "Threading/ThreadPool.h"
 #include "Vector.h"
 
 namespace Rhodochrosite {
@@ -20,29 +31,179 @@ namespace Rhodochrosite {
 		RANDOM_MATERIALS
 	};
 
+	// Which of a scene's sphere BVHs rays traverse. Only scenes that keep their binary BVH, DynamicScene's, can
+	// traverse it, the rest traverse the wide one either way, and scenes without one test every sphere.
+	enum class SphereTraversal {
+		WIDE_BVH,
+		BINARY_BVH
+	};
+
 	enum class SceneName {
 		ONE_SPHERE,
 		SPHERE_ON_PLANE,
 		TWO_SPHERE,
 		LARGE_AMOUNT_OF_SPHERES,
-		RANDOM_SPHERES
+		RANDOM_SPHERES,
+		MANY_LIGHTS
+	};
+
+	struct StreamingSettings {
+		unsigned int width{ 0 };
+		unsigned int height{ 0 };
+		unsigned int rowsPerBand{ 64 };
+		unsigned int bandsInFlight{ 2 }; // Finished bands waiting for the writer
+	};
+
+	// Rectangle of pixels, y counts up from the bottom row like the image
+	struct Tile {
+		unsigned int x{ 0 };
+		unsigned int y{ 0 };
+		unsigned int width{ 0 };
+		unsigned int height{ 0 };
+	};
+
+	// Pixels one pass of a frame evaluates, those on a stride x stride grid except the ones on the grid twice
+	// as coarse, which earlier passes have done. The coarsest pass does its whole grid.
+	struct PixelLattice {
+		unsigned int stride{ 1 };
+		bool coarsest{ true };
+
+		[[nodiscard]] bool contains(unsigned int x, unsigned int y) const;
+	};
+
+	// Memory owned by the caller that a Renderer draws into
+	struct RenderTarget {
+		void* pixels{ nullptr };   // First pixel of the rectangle's bottom row
+		std::ptrdiff_t pitch{ 0 }; // Bytes from a row to the one above it, negative for top down buffers
+		PixelFormat format{ PixelFormat::RGBA8 };
 	};
 
 	class Renderer {
 	public:
-		Renderer(unsigned int width, unsigned int height, Ruby::Camera& camera);
+		using PerPixelAlgorithm = Ruby::Colour(Renderer::*)(const Malachite::Vector2f& texCords) const;
+
+		Renderer(unsigned int width, unsigned int height, Ruby::Camera& camera, ThreadPool& pool = ThreadPool::shared());
+		~Renderer();
 
+		Renderer(const Renderer& other) = delete;
+		Renderer& operator=(const Renderer& other) = delete;
+
+		// Blocks until the whole frame is rendered
 		void render();
+
+		// Starts rendering a frame in tiles on the thread pool and returns straight away. Any frame
+		// still in flight is cancelled first. Must be called from the thread that takes completed tiles.
+		void beginRender();
+		void cancelRender();
+		void waitForRender();
+		[[nodiscard]] bool isRenderComplete();
+
+		// Moves every tile finished since the last call into tiles. Their pixels in getImage() are held unchanged, later passes
+		// waiting to write them, until releaseCompletedTiles, the next takeCompletedTiles or waitForRender.
+		void takeCompletedTiles(std::vector<Tile>& tiles);
+		void releaseCompletedTiles();
+
+		// Takes effect from the next frame
+		void setTileSize(const unsigned int tileSize) { m_TileSize = tileSize == 0 ? 1 : tileSize; }
+		[[nodiscard]] unsigned int getTileSize() const { return m_TileSize; }
+
+		// Frames are rendered in passes of 1 in 64, 1 in 16, 1 in 4 and then every pixel, each pixel evaluated in exactly one
+		// of them. The pixels a pass has not reached copy the nearest one above and to the left that it has. takeCompletedTiles
+		// hands out every tile with a pass finished since the last call, once however many passes that was, and a held tile's
+		// next pass is only written back once it is released. Tiles grow to a multiple of 8 pixels. Takes effect from the next frame.
+		void setProgressivePreview(const bool progressive) { m_ProgressivePreview = progressive; }
+		[[nodiscard]] bool getProgressivePreview() const { return m_ProgressivePreview; }
+
+		// Passes of the current frame every tile has finished, the frame is complete at 4 with the preview on and 1 without
+		[[nodiscard]] unsigned int getCompletedPasses() const;
+
+		// Renders at any resolution in bands of rows handed to writer on another thread. Only the bands
+		// in flight are ever allocated, so the resolution is not limited by memory.
+		bool renderStreaming(ScanlineWriter& writer, const StreamingSettings& settings);
+
+		// Renders rect of a width x height frame straight into target without any intermediate buffer, blocking
+		// until it is done. Cancels the frame in flight. The frame size is independent of the renderer's own image.
+		bool renderInto(const RenderTarget& target, const Tile& rect, unsigned int width, unsigned int height);
+
 		Ruby::Image& getImage() { return m_RenderImage; }
+		[[nodiscard]] SceneSnapshot getScene() const;
+
+		// Safe to call while a frame is rendering, the new snapshot is picked up by the next frame
+		void setScene(SceneSnapshot scene);
+		void setAlgorithm(PerPixelAlgorithm algorithm); // Cancels the frame in flight
+		[[nodiscard]] static PerPixelAlgorithm perPixelAlgorithm(RenderingAlgorithm algorithm);
+
+		// Lights picked from the scene's light tree per shading point, scenes with no more lights than this sum them all.
+		// Cancels the frame in flight.
+		void setLightSamples(unsigned int lightSamples);
+		[[nodiscard]] unsigned int getLightSamples() const { return m_LightSamples; }
+
+		// All diffuse traces a rectangle's paths a bounce at a time. Bounces with at least this many rays
+		// are sorted by origin and direction before they are traced, 0 never sorts. Off by default, a tile's
+		// few hundred rays cost more to sort than they save. Cancels the frame in flight.
+		void setRaySortThreshold(unsigned int threshold);
+		[[nodiscard]] unsigned int getRaySortThreshold() const { return m_RaySortThreshold; }
 
-		void setScene(const Scene& scene);
-		void setAlgorithm(Ruby::Colour(Renderer::* algorithm)(const Malachite::Vector2f& texCords) const);
+		// Numbers used for pixel jitter, light choices and bounce directions, a RandomSampler by default. Cancels the frame in flight.
+		void setSampler(std::shared_ptr<const Sampler> sampler);
+		[[nodiscard]] const Sampler& getSampler() const { return *m_Sampler; }
+
+		// Samples averaged per pixel, jittered inside the pixel when there is more than one. Cancels the frame in flight.
+		void setSamplesPerPixel(unsigned int samplesPerPixel);
+		[[nodiscard]] unsigned int getSamplesPerPixel() const { return m_SamplesPerPixel; }
+
+		// Frames from beginRender keep every pixel's primary hit and accumulated colour. The next frame reprojects them into
+		// its camera and pixels that find the same surface keep its colour instead of being shaded again, only pixels that
+		// were hidden or off screen are shaded. While the camera is still, pixels keep adding samples up to the history limit.
+		// Every CPU algorithm shades a hit the same from any view, so all of them reproject. Changing the scene, algorithm,
+		// sampler or samples per pixel starts the history again. Cancels the frame in flight.
+		void setTemporalReprojection(bool enabled);
+		[[nodiscard]] bool getTemporalReprojection() const { return m_TemporalReprojection; }
+		void setTemporalHistoryLimit(unsigned int samples); // Cancels the frame in flight
+		[[nodiscard]] unsigned int getTemporalHistoryLimit() const { return m_TemporalHistoryLimit; }
+
+		struct TemporalStats {
+			unsigned int reprojectedPixels{ 0 }; // Kept their history without new samples
+			unsigned int shadedPixels{ 0 };
+		};
+		// Of the frame in flight, or the last one
+		[[nodiscard]] TemporalStats getTemporalStats() const;
+
+		// Cancels the frame in flight
+		void setSphereTraversal(SphereTraversal traversal);
+		[[nodiscard]] SphereTraversal getSphereTraversal() const { return m_SphereTraversal; }
+
+		// Once a diffuse path's throughput falls below throughputThreshold, groups of spheres covering less than
+		// tolerance / throughput of its view, as (radius / distance)^2, are hit as one proxy sphere. What a proxy gets
+		// wrong is weighted by the throughput. Pays off for clustered spheres seen from afar, a uniform cloud has little
+		// a ray can skip. A threshold of 0 turns it off. The proxies hang off the wide hierarchy whichever traversal is
+		// set, and are built when a frame first needs them for a snapshot. Cancels the frame in flight.
+		void setGeometricLOD(float throughputThreshold, float tolerance = defaultLODTolerance);
+		[[nodiscard]] float getGeometricLODThreshold() const { return m_LODThreshold; }
+		[[nodiscard]] float getGeometricLODTolerance() const { return m_LODTolerance; }
+		static constexpr float defaultLODThreshold = 0.2f;
+		static constexpr float defaultLODTolerance = 0.001f;
+
+		// Rays traced by batched rendering since construction, for measuring throughput
+		[[nodiscard]] std::uint64_t getRaysTraced() const { return m_RaysTraced.load(std::memory_order_relaxed); }
 
 		struct Hit {
-			const Sphere* hitSphere{ nullptr };
+			const Ruby::Colour* colour{ nullptr };
+			Material material{ Material::DIFFUSE };
+			Malachite::Vector3f normal{ 0.0f }; // Facing the incoming ray
 			float distanceToHit{ std::numeric_limits<float>::max()};
+
+			[[nodiscard]] bool hitSomething() const { return colour != nullptr; }
 		};
 
+		// Ray through texCords ([-1, 1] horizontally, scaled by the aspect ratio vertically)
+		[[nodiscard]] static Ray cameraRay(const Ruby::Camera& camera, const Malachite::Vector2f& texCords);
+		// Inverse of cameraRay, false for points behind the camera
+		[[nodiscard]] static bool projectToTexCords(const Ruby::Camera& camera, const Malachite::Vector3f& point, Malachite::Vector2f& texCords);
+		[[nodiscard]] static Malachite::Vector2f pixelToTexCords(unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+		// Position inside the frame in pixels, the pixel x covers [x, x + 1)
+		[[nodiscard]] static Malachite::Vector2f pixelToTexCords(const Malachite::Vector2f& pixel, unsigned int width, unsigned int height);
+
 		[[nodiscard]] Ruby::Colour basicLightingAlgorithm(const Malachite::Vector2f& texCords) const;
 		[[nodiscard]] Ruby::Colour allReflectiveAlgorithm(const Malachite::Vector2f& texCords) const;
 		[[nodiscard]] Ruby::Colour allDiffuseAlgorithm(const Malachite::Vector2f& texCords) const;
@@ -54,11 +215,101 @@ namespace Rhodochrosite {
 		unsigned int m_Height;
 
 		Ruby::Camera& m_Camera;
+		Ruby::Camera m_FrameCamera; // Copy pinned for the frame being rendered
+
+		SceneSnapshot m_Scene;      // Latest published snapshot, only accessed atomically
+		SceneSnapshot m_FrameScene; // Snapshot pinned for the frame being rendered
+		std::shared_ptr<const SphereClusters> m_FrameClusters; // Of the pinned snapshot's wide hierarchy, only while LOD is on
+
+		ThreadPool& m_Pool;
+		TaskGroup m_Frame;
+		std::atomic<bool> m_Cancelled{ false };
+
+		static constexpr unsigned int previewPasses = 4;
+		static constexpr unsigned int previewStride = 8; // Of the first pass, halved by every pass after it
+
+		// Work is handed out to workers through m_NextTile, pass by pass, each index a tile of one pass
+		unsigned int m_TileSize{ 32 };
+		bool m_ProgressivePreview{ false };
+		unsigned int m_FramePasses{ 1 };
+		std::vector<Tile> m_Tiles;
+		std::atomic<unsigned int> m_NextTile{ 0 };
+
+		// A tile's pass waits for the tile's previous pass, whose gap filling it would otherwise race with
+		std::unique_ptr<std::atomic<unsigned int>[]> m_TilePassesDone;
+		std::array<std::atomic<unsigned int>, previewPasses> m_PassTilesDone{};
+
+		// Passes after the first are rendered into a copy of the tile and written back only while nobody holds the tile
+		enum class TileHold : unsigned char { FREE, HELD, WRITING };
+		std::unique_ptr<std::atomic<TileHold>[]> m_TileHolds;
+		std::vector<unsigned int> m_HeldTiles;
+
+		// Finished tiles are pushed onto a lock-free stack made of preallocated nodes, one per tile
+		struct CompletedTile {
+			Tile tile{};
+			CompletedTile* next{ nullptr };
+		};
+		std::vector<CompletedTile> m_CompletedTileNodes;
+		std::atomic<CompletedTile*> m_CompletedTiles{ nullptr };
+
+		unsigned int m_LightSamples{ 4 };
+
+		std::shared_ptr<const Sampler> m_Sampler;
+		unsigned int m_SamplesPerPixel{ 1 };
+
+		// Primary hit and running mean of a pixel, depth is 0 for a miss and samples 0 for nothing to reuse
+		struct TemporalSample {
+			float depth{ 0.0f };
+			Malachite::Vector3f normal{ 0.0f };
+			Malachite::Vector3f radiance{ 0.0f };
+			unsigned int samples{ 0 };
+		};
+
+		bool m_TemporalReprojection{ false };
+		unsigned int m_TemporalHistoryLimit{ 32 };
+		bool m_FrameTemporal{ false };    // Whether the frame in flight, or the last one, writes history
+		bool m_CameraStill{ false };      // Frame camera is the history's camera
+		std::array<std::vector<TemporalSample>, 2> m_TemporalHistory; // Written by the frame and the complete frame before it
+		unsigned int m_TemporalFrame{ 0 }; // Index of the history the frame writes
+		bool m_TemporalHistoryValid{ false };
+		Ruby::Camera m_HistoryCamera;
+		SceneSnapshot m_HistoryScene;
+		Ruby::Camera m_TemporalFrameCamera; // Kept apart from the frame's, renderInto and renderStreaming pin their own
+		SceneSnapshot m_TemporalFrameScene;
+		std::atomic<unsigned int> m_ReprojectedPixels{ 0 };
+		std::atomic<unsigned int> m_ShadedPixels{ 0 };
+
+		SphereTraversal m_SphereTraversal{ SphereTraversal::WIDE_BVH };
+		float m_LODThreshold{ 0.0f };
+		float m_LODTolerance{ defaultLODTolerance };
+		unsigned int m_RaySortThreshold{ 0 };
+		mutable std::atomic<std::uint64_t> m_RaysTraced{ 0 };
+
+		void pinFrame();
+		void beginTemporalFrame(bool lastFrameComplete);
+		void invalidateTemporalHistory();
+		void renderTiles();
+		void publishTile(unsigned int index);
+		[[nodiscard]] PixelLattice passLattice(unsigned int pass) const;
 
-		Scene m_Scene;
+		// destination points at the rectangle's first pixel, rows are pitch bytes apart. Only the lattice's pixels are written.
+		void renderRect(const Tile& rect, unsigned int width, unsigned int height, unsigned char* destination, std::ptrdiff_t pitch, PixelFormat format = PixelFormat::RGBA8, PixelLattice lattice = {}) const;
+		void renderDiffuseRect(const Tile& rect, unsigned int width, unsigned int height, unsigned char* destination, std::ptrdiff_t pitch, PixelFormat format, PixelLattice lattice) const;
+		// Shades only the pixels whose history cannot be reprojected, into the frame's image and history
+		void renderTemporalRect(const Tile& rect, unsigned char* destination, std::ptrdiff_t pitch, PixelLattice lattice);
+		[[nodiscard]] const TemporalSample* reprojectHistory(const Malachite::Vector3f& position, const Malachite::Vector3f& normal) const;
+		// Copies every pixel on the lattice's grid over the rest of its stride x stride block inside rect
+		static void fillLatticeGaps(const Tile& rect, unsigned char* destination, std::ptrdiff_t pitch, PixelLattice lattice);
 
-		[[nodiscard]] Hit hitSpheres(const Ray& ray) const;
+		// Camera position of a pixel's sample, jittered inside the pixel when rendering more than one
+		[[nodiscard]] Malachite::Vector2f sampleTexCords(unsigned int x, unsigned int y, unsigned int sample, unsigned int width, unsigned int height) const;
+		[[nodiscard]] Ray primaryRay(const Malachite::Vector2f& texCords) const;
+		// throughput is what the path's hit will be weighted by, low enough and spheres are hit through their clusters
+		[[nodiscard]] Hit hitScene(const Ray& ray, float throughput = 1.0f) const;
+		[[nodiscard]] float directionalLightIntensity(const Malachite::Vector3f& normal) const;
+		[[nodiscard]] Malachite::Vector3f emitterLight(const Malachite::Vector3f& position, const Malachite::Vector3f& normal) const;
+		[[nodiscard]] Malachite::Vector4f shade(const Ray& ray, const Hit& hit) const;
 
-		Ruby::Colour(Renderer::* m_PerPixelAlgorithm)(const Malachite::Vector2f& texCords) const;
+		PerPixelAlgorithm m_PerPixelAlgorithm;
 	};
 }
\ No newline at end of file
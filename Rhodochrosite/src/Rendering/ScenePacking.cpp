@@ -0,0 +1,117 @@
+#include "ScenePacking.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace Rhodochrosite {
+	namespace {
+		constexpr size_t countBytes = 16; // The count is an int, but arrays of 16 byte aligned structs start at 16
+
+		int materialIndex(const Material material) {
+			switch (material) {
+			case Material::REFLECTION:
+				return 1;
+			case Material::REFRACTION:
+				return 2;
+			default:
+			case Material::DIFFUSE:
+				return 0;
+			}
+		}
+
+		class SectionWriter {
+		public:
+			SectionWriter(std::vector<unsigned char>& bytes, const size_t offset)
+				: m_Bytes(bytes)
+				, m_Offset(offset) { }
+
+			void write(const size_t at, const float value) { std::memcpy(m_Bytes.data() + m_Offset + at, &value, sizeof(value)); }
+			void write(const size_t at, const std::int32_t value) { std::memcpy(m_Bytes.data() + m_Offset + at, &value, sizeof(value)); }
+			void write(const size_t at, const Malachite::Vector3f& value) {
+				write(at, value.x);
+				write(at + 4, value.y);
+				write(at + 8, value.z);
+			}
+			void write(const size_t at, const Ruby::Colour& value) {
+				write(at, value.colour.x);
+				write(at + 4, value.colour.y);
+				write(at + 8, value.colour.z);
+				write(at + 12, value.colour.w);
+			}
+
+		private:
+			std::vector<unsigned char>& m_Bytes;
+			size_t m_Offset;
+		};
+
+		size_t alignUp(const size_t value, const size_t alignment) {
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+		PackedScene::Section section(const size_t offset, const size_t count, const size_t stride) {
+			return PackedScene::Section{ offset, countBytes + count * stride };
+		}
+	}
+
+	void packScene(const Scene& scene, const size_t sectionAlignment, PackedScene& packed) {
+		packed.spheres = section(0, scene.spheres.size(), packedSphereBytes);
+		packed.planes = section(alignUp(packed.spheres.offset + packed.spheres.size, sectionAlignment), scene.planes.size(), packedPlaneBytes);
+		packed.discs = section(alignUp(packed.planes.offset + packed.planes.size, sectionAlignment), scene.discs.size(), packedDiscBytes);
+		packed.directionalLights = section(alignUp(packed.discs.offset + packed.discs.size, sectionAlignment), scene.lights.size(), packedDirectionalLightBytes);
+
+		// Padding is zeroed so the same scene always packs to the same bytes
+		packed.bytes.assign(packed.directionalLights.offset + packed.directionalLights.size, 0);
+
+		SectionWriter spheres{ packed.bytes, packed.spheres.offset };
+		spheres.write(0, static_cast<std::int32_t>(scene.spheres.size()));
+		for (size_t i = 0; i < scene.spheres.size(); i++) {
+			const Sphere& sphere = scene.spheres[i];
+			const size_t at = countBytes + i * packedSphereBytes;
+			spheres.write(at, sphere.origin);
+			spheres.write(at + 12, sphere.radius);
+			spheres.write(at + 16, sphere.colour);
+			spheres.write(at + 32, materialIndex(sphere.material));
+		}
+
+		SectionWriter planes{ packed.bytes, packed.planes.offset };
+		planes.write(0, static_cast<std::int32_t>(scene.planes.size()));
+		for (size_t i = 0; i < scene.planes.size(); i++) {
+			const Plane& plane = scene.planes[i];
+			const size_t at = countBytes + i * packedPlaneBytes;
+			planes.write(at, plane.origin);
+			planes.write(at + 16, plane.normal);
+			planes.write(at + 32, plane.colour);
+			planes.write(at + 48, materialIndex(plane.material));
+		}
+
+		SectionWriter discs{ packed.bytes, packed.discs.offset };
+		discs.write(0, static_cast<std::int32_t>(scene.discs.size()));
+		for (size_t i = 0; i < scene.discs.size(); i++) {
+			const Disc& disc = scene.discs[i];
+			const size_t at = countBytes + i * packedDiscBytes;
+			discs.write(at, disc.origin);
+			discs.write(at + 16, disc.normal);
+			discs.write(at + 28, disc.radius);
+			discs.write(at + 32, disc.colour);
+			discs.write(at + 48, materialIndex(disc.material));
+		}
+
+		SectionWriter lights{ packed.bytes, packed.directionalLights.offset };
+		lights.write(0, static_cast<std::int32_t>(scene.lights.size()));
+		for (size_t i = 0; i < scene.lights.size(); i++) {
+			lights.write(countBytes + i * packedDirectionalLightBytes, scene.lights[i].direction);
+		}
+	}
+
+	bool ScenePacker::update(const SceneSnapshot& scene) {
+		if (m_HasPacked && scene == m_Scene) {
+			return false;
+		}
+
+		packScene(scene == nullptr ? Scene{} : *scene, m_SectionAlignment, m_Packed);
+		m_Scene = scene;
+		m_HasPacked = true;
+		m_PackCount++;
+		return true;
+	}
+}
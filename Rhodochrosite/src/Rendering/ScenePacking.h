@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Scene.h"
+
+namespace Rhodochrosite {
+	// The scene laid out for the shaders' storage buffers. Each section is an int count padded to 16 bytes and then
+	// the array, every element matching the std430 layout of its struct in the fragment shaders.
+	struct PackedScene {
+		struct Section {
+			size_t offset{ 0 }; // Bytes from the start of the buffer, a multiple of the alignment it was packed with
+			size_t size{ 0 };
+		};
+
+		std::vector<unsigned char> bytes;
+		Section spheres;
+		Section planes;
+		Section discs;
+		Section directionalLights;
+	};
+
+	// std430 strides of Sphere, Plane, Disc and DirectionalLight in the shaders
+	constexpr size_t packedSphereBytes = 48;
+	constexpr size_t packedPlaneBytes = 64;
+	constexpr size_t packedDiscBytes = 64;
+	constexpr size_t packedDirectionalLightBytes = 16;
+
+	// Storage buffer binding points the sections are bound to, in order
+	constexpr unsigned int sceneBufferFirstBinding = 0;
+
+	// sectionAlignment is the smallest offset alignment the GL accepts for a buffer range, reuses packed's memory
+	void packScene(const Scene& scene, size_t sectionAlignment, PackedScene& packed);
+
+	// Packs a scene only when it is handed a different snapshot than last time. Snapshots are immutable,
+	// so the same pointer always means the same contents.
+	class ScenePacker {
+	public:
+		explicit ScenePacker(size_t sectionAlignment = 256) : m_SectionAlignment(sectionAlignment == 0 ? 1 : sectionAlignment) { }
+
+		// Returns whether the packed scene changed
+		bool update(const SceneSnapshot& scene);
+
+		[[nodiscard]] const PackedScene& getPacked() const { return m_Packed; }
+		[[nodiscard]] unsigned int getPackCount() const { return m_PackCount; }
+
+	private:
+		size_t m_SectionAlignment;
+		SceneSnapshot m_Scene; // Held so its address cannot be reused by a different snapshot
+		bool m_HasPacked{ false };
+		PackedScene m_Packed;
+		unsigned int m_PackCount{ 0 };
+	};
+}
@@ -0,0 +1,90 @@
+#include "SessionRecording.h"
+
+#include <cstring>
+
+namespace Rhodochrosite {
+	SessionRecorder::SessionRecorder(const std::filesystem::path& path, const unsigned int width, const unsigned int height)
+		: m_File(path, std::ios::binary | std::ios::trunc)
+		, m_Start(std::chrono::steady_clock::now()) {
+		SessionFileHeader header{};
+		header.width = width;
+		header.height = height;
+		m_File.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	}
+
+	void SessionRecorder::recordCamera(const Ruby::Camera& camera) {
+		const SessionCameraState state{
+			{ camera.position.x, camera.position.y, camera.position.z },
+			{ camera.front.x, camera.front.y, camera.front.z }
+		};
+		if (m_HasCamera && std::memcmp(&state, &m_LastCamera, sizeof(state)) == 0) {
+			return;
+		}
+
+		m_HasCamera = true;
+		m_LastCamera = state;
+		writeEvent(SessionEvent::Type::CAMERA, 0);
+		m_File.write(reinterpret_cast<const char*>(&state), sizeof(state));
+	}
+
+	void SessionRecorder::recordScene(const SceneName scene) {
+		writeEvent(SessionEvent::Type::SCENE, static_cast<std::uint8_t>(scene));
+	}
+
+	void SessionRecorder::recordAlgorithm(const RenderingAlgorithm algorithm) {
+		writeEvent(SessionEvent::Type::ALGORITHM, static_cast<std::uint8_t>(algorithm));
+	}
+
+	void SessionRecorder::recordDevice(const RenderingDevice device) {
+		writeEvent(SessionEvent::Type::DEVICE, static_cast<std::uint8_t>(device));
+	}
+
+	void SessionRecorder::writeEvent(const SessionEvent::Type type, const std::uint8_t value) {
+		const SessionEventHeader header{
+			std::chrono::duration<float>(std::chrono::steady_clock::now() - m_Start).count(),
+			static_cast<std::uint8_t>(type),
+			value,
+			{ 0, 0 }
+		};
+		m_File.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	}
+
+	std::optional<Session> loadSession(const std::filesystem::path& path) {
+		std::ifstream file{ path, std::ios::binary };
+
+		SessionFileHeader header{};
+		if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.magic, SessionFileHeader{}.magic, sizeof(header.magic)) != 0
+			|| header.version != SessionFileHeader{}.version) {
+			return std::nullopt;
+		}
+
+		Session session{};
+		session.width = header.width;
+		session.height = header.height;
+
+		// A session cut short by a crash still replays up to its last whole event
+		SessionEventHeader eventHeader{};
+		while (file.read(reinterpret_cast<char*>(&eventHeader), sizeof(eventHeader))) {
+			SessionEvent event{};
+			event.time = eventHeader.time;
+			event.type = static_cast<SessionEvent::Type>(eventHeader.type);
+			event.value = eventHeader.value;
+
+			if (event.type == SessionEvent::Type::CAMERA) {
+				SessionCameraState state{};
+				if (!file.read(reinterpret_cast<char*>(&state), sizeof(state))) {
+					break;
+				}
+				event.position = Malachite::Vector3f{ state.position[0], state.position[1], state.position[2] };
+				event.front = Malachite::Vector3f{ state.front[0], state.front[1], state.front[2] };
+			}
+			else if (event.type > SessionEvent::Type::DEVICE) {
+				return std::nullopt;
+			}
+
+			session.events.push_back(event);
+		}
+
+		return session;
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <vector>
+
+#include "Camera.h"
+#include "Rendering/Renderer.h"
+#include "Vector.h"
+
+namespace Rhodochrosite {
+	struct SessionEvent {
+		enum class Type : std::uint8_t {
+			CAMERA,
+			SCENE,     // value is a SceneName
+			ALGORITHM, // value is a RenderingAlgorithm
+			DEVICE     // value is a RenderingDevice
+		};
+
+		float time{ 0.0f }; // Seconds since recording started
+		Type type{ Type::CAMERA };
+		std::uint8_t value{ 0 };
+
+		Malachite::Vector3f position{ 0.0f }; // Camera events only
+		Malachite::Vector3f front{ 0.0f };
+	};
+
+	// Session files start with this header, then every event is a SessionEventHeader followed,
+	// for camera events only, by a SessionCameraState
+	struct SessionFileHeader {
+		char magic[4]{ 'R', 'S', 'E', 'S' };
+		std::uint32_t version{ 1 };
+		std::uint32_t width{ 0 };
+		std::uint32_t height{ 0 };
+	};
+	static_assert(sizeof(SessionFileHeader) == 16, "SessionFileHeader is read straight from disk");
+
+	struct SessionEventHeader {
+		float time;
+		std::uint8_t type;
+		std::uint8_t value;
+		std::uint8_t padding[2];
+	};
+	static_assert(sizeof(SessionEventHeader) == 8, "SessionEventHeader is read straight from disk");
+
+	struct SessionCameraState {
+		float position[3];
+		float front[3];
+	};
+	static_assert(sizeof(SessionCameraState) == 24, "SessionCameraState is read straight from disk");
+
+	struct Session {
+		unsigned int width{ 0 };
+		unsigned int height{ 0 };
+		std::vector<SessionEvent> events;
+	};
+
+	// Appends events to a session file as they happen. Camera states are only written when the camera
+	// actually moved, so an idle session costs nothing.
+	class SessionRecorder {
+	public:
+		SessionRecorder(const std::filesystem::path& path, unsigned int width, unsigned int height);
+
+		void recordCamera(const Ruby::Camera& camera);
+		void recordScene(SceneName scene);
+		void recordAlgorithm(RenderingAlgorithm algorithm);
+		void recordDevice(RenderingDevice device);
+
+		[[nodiscard]] bool isOpen() const { return m_File.is_open() && m_File.good(); }
+
+	private:
+		std::ofstream m_File;
+		std::chrono::steady_clock::time_point m_Start;
+
+		bool m_HasCamera{ false };
+		SessionCameraState m_LastCamera{};
+
+		void writeEvent(SessionEvent::Type type, std::uint8_t value);
+	};
+
+	[[nodiscard]] std::optional<Session> loadSession(const std::filesystem::path& path);
+}
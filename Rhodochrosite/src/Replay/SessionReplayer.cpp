@@ -0,0 +1,94 @@
+#include "SessionReplayer.h"
+
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+namespace Rhodochrosite {
+	namespace {
+		const char* eventName(const SessionEvent::Type type) {
+			switch (type) {
+			case SessionEvent::Type::CAMERA:
+				return "camera";
+			case SessionEvent::Type::SCENE:
+				return "scene";
+			case SessionEvent::Type::ALGORITHM:
+				return "algorithm";
+			case SessionEvent::Type::DEVICE:
+				return "device";
+			}
+			return "unknown";
+		}
+	}
+
+	bool ReplayReport::writeCSV(const std::filesystem::path& path) const {
+		std::ofstream file{ path, std::ios::trunc };
+		file << "event,type,value,recorded_seconds,issued_seconds,render_milliseconds\n";
+		for (size_t i = 0; i < timings.size(); i++) {
+			const ReplayTiming& timing = timings[i];
+			file << i << ',' << eventName(timing.event.type) << ',' << static_cast<unsigned int>(timing.event.value) << ','
+				<< timing.event.time << ',' << timing.issuedAt << ',' << timing.renderMilliseconds << '\n';
+		}
+		file << "total,,," << (timings.empty() ? 0.0f : timings.back().event.time) << ',' << totalSeconds << ",\n";
+
+		file.close();
+		return !file.fail();
+	}
+
+	SessionReplayer::SessionReplayer(const Session& session, const Scenes& scenes, const TuningConfig& tuning)
+		: m_Session(session)
+		, m_Scenes(scenes)
+		, m_Renderer(session.width, session.height, m_Camera) {
+		applyTuning(tuning, m_Renderer);
+		m_Renderer.setScene(m_Scenes.get(SceneName::ONE_SPHERE));
+	}
+
+	ReplayReport SessionReplayer::replay(const ReplayPacing pacing) {
+		using Clock = std::chrono::steady_clock;
+
+		ReplayReport report{};
+		report.timings.reserve(m_Session.events.size());
+
+		const Clock::time_point start = Clock::now();
+		for (const SessionEvent& event : m_Session.events) {
+			if (pacing == ReplayPacing::RECORDED) {
+				std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(event.time)));
+			}
+
+			ReplayTiming timing{};
+			timing.event = event;
+			timing.issuedAt = std::chrono::duration<double>(Clock::now() - start).count();
+
+			bool render = true;
+			switch (event.type) {
+			case SessionEvent::Type::CAMERA:
+				m_Camera.position = event.position;
+				m_Camera.front = event.front;
+				m_Camera.updateCameraVectors();
+				break;
+			case SessionEvent::Type::SCENE:
+				m_Renderer.setScene(m_Scenes.get(static_cast<SceneName>(event.value)));
+				break;
+			case SessionEvent::Type::ALGORITHM:
+				m_Renderer.setAlgorithm(Renderer::perPixelAlgorithm(static_cast<RenderingAlgorithm>(event.value)));
+				break;
+			case SessionEvent::Type::DEVICE:
+				// Replays always render on the CPU, device switches are only kept for context
+				render = false;
+				break;
+			}
+
+			if (render) {
+				const Clock::time_point renderStart = Clock::now();
+				m_Renderer.render();
+				timing.renderMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - renderStart).count();
+				report.framesRendered++;
+			}
+
+			report.timings.push_back(timing);
+		}
+
+		report.totalSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+		return report;
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+#include "Camera.h"
+#include "Rendering/Autotune.h"
+#include "Rendering/Renderer.h"
+#include "Scenes.h"
+#include "SessionRecording.h"
+
+namespace Rhodochrosite {
+	enum class ReplayPacing {
+		AS_FAST_AS_POSSIBLE,
+		RECORDED // Never issue an event before the time it was recorded at
+	};
+
+	struct ReplayTiming {
+		SessionEvent event{};
+		double issuedAt{ 0.0 };        // Seconds since the replay started
+		double renderMilliseconds{ 0.0 };
+	};
+
+	struct ReplayReport {
+		std::vector<ReplayTiming> timings;
+		double totalSeconds{ 0.0 };
+		unsigned int framesRendered{ 0 };
+
+		bool writeCSV(const std::filesystem::path& path) const;
+	};
+
+	// Re-issues a recorded session against a headless Renderer, rendering a whole frame after every event
+	// that changes what is on screen, and times each one. The renderer is tuned as the interactive one would be.
+	class SessionReplayer {
+	public:
+		SessionReplayer(const Session& session, const Scenes& scenes, const TuningConfig& tuning = TuningConfig{});
+
+		ReplayReport replay(ReplayPacing pacing);
+
+	private:
+		const Session& m_Session;
+		const Scenes& m_Scenes;
+
+		Ruby::Camera m_Camera{};
+		Renderer m_Renderer;
+	};
+}
@@ -0,0 +1,249 @@
+#include "Sampler.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace Rhodochrosite {
+	namespace {
+		constexpr float pi = 3.14159265358979f;
+
+		std::uint32_t hash(std::uint32_t value) {
+			// Wellons' lowbias32
+			value ^= value >> 16;
+			value *= 0x7feb352du;
+			value ^= value >> 15;
+			value *= 0x846ca68bu;
+			value ^= value >> 16;
+			return value;
+		}
+
+		std::uint32_t hashCombine(const std::uint32_t seed, const std::uint32_t value) {
+			return seed ^ (value + 0x9e3779b9u + (seed << 6) + (seed >> 2));
+		}
+
+		float toUnitFloat(const std::uint32_t value) {
+			// Top 24 bits, so the result can never round up to 1
+			return static_cast<float>(value >> 8) * (1.0f / 16777216.0f);
+		}
+
+		std::uint32_t reverseBits(std::uint32_t value) {
+			value = (value << 16) | (value >> 16);
+			value = ((value & 0x00ff00ffu) << 8) | ((value & 0xff00ff00u) >> 8);
+			value = ((value & 0x0f0f0f0fu) << 4) | ((value & 0xf0f0f0f0u) >> 4);
+			value = ((value & 0x33333333u) << 2) | ((value & 0xccccccccu) >> 2);
+			value = ((value & 0x55555555u) << 1) | ((value & 0xaaaaaaaau) >> 1);
+			return value;
+		}
+
+		// Laine and Karras' permutation, an Owen scramble when applied to bit reversed values
+		std::uint32_t nestedUniformScramble(std::uint32_t value, const std::uint32_t seed) {
+			value = reverseBits(value);
+			value += seed;
+			value ^= value * 0x6c50b47cu;
+			value ^= value * 0xb82f1e52u;
+			value ^= value * 0xc7afe638u;
+			value ^= value * 0x8d22f6e6u;
+			return reverseBits(value);
+		}
+
+		using DirectionNumbers = std::array<std::array<std::uint32_t, 32>, 4>;
+
+		// First four Sobol dimensions from Joe and Kuo's primitive polynomials
+		DirectionNumbers makeDirectionNumbers() {
+			struct Polynomial {
+				unsigned int degree;
+				std::uint32_t coefficients;
+				std::array<std::uint32_t, 3> initial;
+			};
+			const Polynomial polynomials[3]{ { 1, 0, { 1, 0, 0 } }, { 2, 1, { 1, 3, 0 } }, { 3, 1, { 1, 3, 1 } } };
+
+			DirectionNumbers directions{};
+			for (unsigned int bit = 0; bit < 32; bit++) {
+				directions[0][bit] = 1u << (31 - bit);
+			}
+
+			for (unsigned int dimension = 1; dimension < 4; dimension++) {
+				const Polynomial& polynomial = polynomials[dimension - 1];
+				std::array<std::uint32_t, 32>& v = directions[dimension];
+
+				for (unsigned int bit = 0; bit < 32; bit++) {
+					if (bit < polynomial.degree) {
+						v[bit] = polynomial.initial[bit] << (31 - bit);
+						continue;
+					}
+
+					v[bit] = v[bit - polynomial.degree] ^ (v[bit - polynomial.degree] >> polynomial.degree);
+					for (unsigned int k = 1; k < polynomial.degree; k++) {
+						if ((polynomial.coefficients >> (polynomial.degree - 1 - k)) & 1u) {
+							v[bit] ^= v[bit - k];
+						}
+					}
+				}
+			}
+			return directions;
+		}
+
+		std::uint32_t sobol(std::uint32_t index, const unsigned int dimension) {
+			static const DirectionNumbers directions = makeDirectionNumbers();
+
+			std::uint32_t value = 0;
+			for (unsigned int bit = 0; index != 0; index >>= 1, bit++) {
+				if (index & 1u) {
+					value ^= directions[dimension][bit];
+				}
+			}
+			return value;
+		}
+
+		// Distinct irrational step per dimension for the additive recurrence, the fractional part of sqrt(prime)
+		float recurrenceStep(const unsigned int dimension) {
+			static const std::array<float, 16> steps = []() {
+				const unsigned int primes[16]{ 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53 };
+				std::array<float, 16> result{};
+				for (unsigned int i = 0; i < 16; i++) {
+					const double root = std::sqrt(static_cast<double>(primes[i]));
+					result[i] = static_cast<float>(root - std::floor(root));
+				}
+				return result;
+			}();
+			return steps[dimension % steps.size()];
+		}
+	}
+
+	float RandomSampler::get(const unsigned int x, const unsigned int y, const unsigned int sampleIndex, const unsigned int dimension) const {
+		return toUnitFloat(hash(hashCombine(hashCombine(hashCombine(hash(x), y), sampleIndex), dimension)));
+	}
+
+	float SobolSampler::get(const unsigned int x, const unsigned int y, const unsigned int sampleIndex, const unsigned int dimension) const {
+		const std::uint32_t seed = hash(hashCombine(hashCombine(hash(x), y), dimension / 4));
+
+		const std::uint32_t index = nestedUniformScramble(sampleIndex, seed);
+		const std::uint32_t value = nestedUniformScramble(sobol(index, dimension % 4), hashCombine(seed, dimension % 4));
+		return toUnitFloat(value);
+	}
+
+	BlueNoiseSampler::BlueNoiseSampler()
+		: m_Mask([]() -> const std::vector<float>& {
+			static const std::vector<float> mask = generateVoidAndClusterMask();
+			return mask;
+		}()) { }
+
+	float BlueNoiseSampler::get(const unsigned int x, const unsigned int y, const unsigned int sampleIndex, const unsigned int dimension) const {
+		// Every dimension reads the mask at its own offset so dimensions are not rotated by the same amount
+		const std::uint32_t offset = hash(dimension + 1);
+		const unsigned int maskX = (x + (offset & 0xffffu)) % maskSize;
+		const unsigned int maskY = (y + (offset >> 16)) % maskSize;
+
+		const float sequence = static_cast<float>(std::fmod(static_cast<double>(sampleIndex) * recurrenceStep(dimension), 1.0));
+		const float value = sequence + m_Mask[maskY * maskSize + maskX];
+		return std::min(value - std::floor(value), 0.99999994f);
+	}
+
+	std::vector<float> BlueNoiseSampler::generateVoidAndClusterMask() {
+		constexpr unsigned int size = maskSize;
+		constexpr unsigned int texels = size * size;
+		constexpr float sigma = 1.5f;
+
+		// Gaussian energy every texel receives from a point at each wrapped offset
+		std::vector<float> kernel(texels);
+		for (unsigned int y = 0; y < size; y++) {
+			for (unsigned int x = 0; x < size; x++) {
+				const float dx = static_cast<float>(std::min(x, size - x));
+				const float dy = static_cast<float>(std::min(y, size - y));
+				kernel[y * size + x] = std::exp(-(dx * dx + dy * dy) / (2.0f * sigma * sigma));
+			}
+		}
+
+		std::vector<unsigned char> points(texels, 0);
+		std::vector<float> energy(texels, 0.0f);
+		const auto toggle = [&](const unsigned int texel, const bool on) {
+			points[texel] = on ? 1 : 0;
+			const unsigned int px = texel % size;
+			const unsigned int py = texel / size;
+			const float sign = on ? 1.0f : -1.0f;
+			for (unsigned int y = 0; y < size; y++) {
+				for (unsigned int x = 0; x < size; x++) {
+					energy[y * size + x] += sign * kernel[((y + size - py) % size) * size + (x + size - px) % size];
+				}
+			}
+		};
+
+		const auto tightestCluster = [&]() {
+			unsigned int best = 0;
+			float bestEnergy = -1.0f;
+			for (unsigned int i = 0; i < texels; i++) {
+				if (points[i] && energy[i] > bestEnergy) {
+					bestEnergy = energy[i];
+					best = i;
+				}
+			}
+			return best;
+		};
+		const auto largestVoid = [&]() {
+			unsigned int best = 0;
+			float bestEnergy = std::numeric_limits<float>::max();
+			for (unsigned int i = 0; i < texels; i++) {
+				if (!points[i] && energy[i] < bestEnergy) {
+					bestEnergy = energy[i];
+					best = i;
+				}
+			}
+			return best;
+		};
+
+		// Initial pattern, a tenth of the texels placed pseudo randomly and then relaxed until the tightest
+		// cluster is also the largest void
+		const unsigned int initialPoints = texels / 10;
+		for (unsigned int i = 0, placed = 0; placed < initialPoints; i++) {
+			const unsigned int texel = hash(i) % texels;
+			if (!points[texel]) {
+				toggle(texel, true);
+				placed++;
+			}
+		}
+		while (true) {
+			const unsigned int cluster = tightestCluster();
+			toggle(cluster, false);
+			const unsigned int gap = largestVoid();
+			toggle(gap, true);
+			if (gap == cluster) {
+				break;
+			}
+		}
+
+		const std::vector<unsigned char> initialPattern = points;
+		const std::vector<float> initialEnergy = energy;
+		std::vector<unsigned int> rank(texels, 0);
+
+		// Ranks below the initial points come from removing clusters, the rest from filling voids
+		for (unsigned int remaining = initialPoints; remaining > 0; remaining--) {
+			const unsigned int cluster = tightestCluster();
+			toggle(cluster, false);
+			rank[cluster] = remaining - 1;
+		}
+
+		points = initialPattern;
+		energy = initialEnergy;
+		for (unsigned int filled = initialPoints; filled < texels; filled++) {
+			const unsigned int gap = largestVoid();
+			toggle(gap, true);
+			rank[gap] = filled;
+		}
+
+		std::vector<float> mask(texels);
+		for (unsigned int i = 0; i < texels; i++) {
+			mask[i] = (static_cast<float>(rank[i]) + 0.5f) / static_cast<float>(texels);
+		}
+		return mask;
+	}
+
+	Malachite::Vector3f sampleUnitBall(const float u1, const float u2, const float u3) {
+		const float z = 1.0f - 2.0f * u1;
+		const float ring = std::sqrt(std::max(0.0f, 1.0f - z * z));
+		const float phi = 2.0f * pi * u2;
+		const float radius = std::cbrt(u3);
+		return Malachite::Vector3f{ ring * std::cos(phi), ring * std::sin(phi), z } * radius;
+	}
+}
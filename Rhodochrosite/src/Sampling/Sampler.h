@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Vector.h"
+
+namespace Rhodochrosite {
+	// Source of the numbers a render consumes. Every value is addressed by pixel, sample index and dimension,
+	// so the same pixel sample always sees the same numbers no matter which thread renders it or in what order.
+	// Dimensions 0 and 1 jitter the camera ray inside the pixel, the rest are used in the order a path needs them.
+	class Sampler {
+	public:
+		virtual ~Sampler() = default;
+
+		// Value in [0, 1)
+		[[nodiscard]] virtual float get(unsigned int x, unsigned int y, unsigned int sampleIndex, unsigned int dimension) const = 0;
+	};
+
+	// Independent uniform numbers, what the renderer has always used
+	class RandomSampler : public Sampler {
+	public:
+		[[nodiscard]] float get(unsigned int x, unsigned int y, unsigned int sampleIndex, unsigned int dimension) const override;
+	};
+
+	// Sobol points with hash based Owen scrambling, shuffled differently for every pixel. Dimensions come in
+	// groups of four Sobol dimensions, every group shuffled independently so the groups do not correlate.
+	class SobolSampler : public Sampler {
+	public:
+		[[nodiscard]] float get(unsigned int x, unsigned int y, unsigned int sampleIndex, unsigned int dimension) const override;
+	};
+
+	// Additive recurrence per dimension, rotated per pixel by a blue noise mask, so the error left at low
+	// sample counts is spread out as high frequency noise instead of clumps
+	class BlueNoiseSampler : public Sampler {
+	public:
+		BlueNoiseSampler();
+
+		[[nodiscard]] float get(unsigned int x, unsigned int y, unsigned int sampleIndex, unsigned int dimension) const override;
+
+		static constexpr unsigned int maskSize = 64;
+
+		// Rank of every texel of a maskSize x maskSize void and cluster mask, divided by the texel count
+		[[nodiscard]] static std::vector<float> generateVoidAndClusterMask();
+
+	private:
+		const std::vector<float>& m_Mask;
+	};
+
+	// Uniformly distributed point inside the unit sphere from three sampler values
+	[[nodiscard]] Malachite::Vector3f sampleUnitBall(float u1, float u2, float u3);
+}
@@ -0,0 +1,53 @@
+#include "ShaderRandom.h"
+
+#include <cmath>
+
+namespace Rhodochrosite {
+	namespace {
+		constexpr float PHI = 1.61803398874989484820459f;
+
+		float fract(const float value) {
+			return value - std::floor(value);
+		}
+
+		float sinHash(const Malachite::Vector2f& state) {
+			return fract(std::sin(state.x * 12.9898f + state.y * 78.233f) * 43758.5453f);
+		}
+	}
+
+	float shaderRandomFloat(const Malachite::Vector2f& textureCordinates, const float aspectRatio, const float seed) {
+		const Malachite::Vector2f coord{ textureCordinates.x * 1000.0f, textureCordinates.y * 1000.0f * aspectRatio };
+		// distance(coord * PHI, coord)
+		const float distance = std::sqrt(coord.x * coord.x + coord.y * coord.y) * (PHI - 1.0f);
+		return fract(std::tan(distance * std::tan(seed)) * coord.x);
+	}
+
+	ShaderRandomState::ShaderRandomState(const Malachite::Vector2f& textureCordinates, const float time)
+		: m_State{ textureCordinates.x * time, textureCordinates.y * time } { }
+
+	float ShaderRandomState::next() {
+		// The shader hashes x before hashing y, so y is hashed from the new x
+		m_State.x = sinHash(m_State);
+		m_State.y = sinHash(m_State);
+		return m_State.x;
+	}
+
+	ShaderHashSampler::ShaderHashSampler(const unsigned int width, const unsigned int height)
+		: m_Width(width == 0 ? 1 : width)
+		, m_Height(height == 0 ? 1 : height) { }
+
+	float ShaderHashSampler::get(const unsigned int x, const unsigned int y, const unsigned int sampleIndex, const unsigned int dimension) const {
+		const Malachite::Vector2f textureCordinates{
+			(static_cast<float>(x) + 0.5f) / static_cast<float>(m_Width),
+			(static_cast<float>(y) + 0.5f) / static_cast<float>(m_Height)
+		};
+
+		// The shader's state is sequential, reaching a dimension means replaying every one before it
+		ShaderRandomState state{ textureCordinates, static_cast<float>(sampleIndex + 1) };
+		float value = 0.0f;
+		for (unsigned int i = 0; i <= dimension; i++) {
+			value = state.next();
+		}
+		return value;
+	}
+}
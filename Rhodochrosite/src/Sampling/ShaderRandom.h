@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Sampler.h"
+#include "Vector.h"
+
+namespace Rhodochrosite {
+	// CPU copies of the randomFloat functions in the fragment shaders, so their noise can be measured against
+	// the samplers. GPUs differ in the precision of sin and tan, results only match to a few bits.
+
+	// Default.frag and AllReflective.frag, a function of the fragment and the seed only
+	[[nodiscard]] float shaderRandomFloat(const Malachite::Vector2f& textureCordinates, float aspectRatio, float seed);
+
+	// AllDiffuse.frag, every call advances a state seeded from the fragment and the time
+	class ShaderRandomState {
+	public:
+		ShaderRandomState(const Malachite::Vector2f& textureCordinates, float time);
+
+		[[nodiscard]] float next();
+
+	private:
+		Malachite::Vector2f m_State;
+	};
+
+	// AllDiffuse.frag's numbers behind the Sampler interface, the time standing in for the sample index
+	class ShaderHashSampler : public Sampler {
+	public:
+		ShaderHashSampler(unsigned int width, unsigned int height);
+
+		[[nodiscard]] float get(unsigned int x, unsigned int y, unsigned int sampleIndex, unsigned int dimension) const override;
+
+	private:
+		unsigned int m_Width;
+		unsigned int m_Height;
+	};
+}
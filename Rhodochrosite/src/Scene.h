@@ -1,13 +1,57 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 
+#include "Acceleration/SphereBVH.h"
+#include "Acceleration/WideSphereBVH.h"
+#include "Lighting/LightTree.h"
 #include "Lights.h"
+#include "Plane.h"
 #include "Sphere.h"
 
 namespace Rhodochrosite {
 	struct Scene {
 		std::vector<Sphere> spheres;
+		std::vector<Plane> planes; // Kept out of the sphere set so they never inflate its bounds
+		std::vector<Disc> discs;
 		std::vector<Ruby::DirectionalLight> lights;
+
+		std::vector<PointLight> pointLights;
+		std::vector<SphereLight> sphereLights;
+
+		// Derived data, makeSnapshot builds whatever is missing and editSnapshot drops it before an edit
+		std::shared_ptr<const LightTree> lightTree;
+		std::shared_ptr<const SphereBVH> sphereBVH; // Only kept when given, as DynamicScene does to refit it
+		std::shared_ptr<const WideSphereBVH> wideSphereBVH; // What rays traverse, left empty for scenes small enough to test every sphere
 	};
-}
\ No newline at end of file
+
+	constexpr size_t sphereBVHMinimumSpheres = 16;
+
+	// Scenes are shared as immutable, reference counted snapshots. Publishing one is a pointer swap,
+	// and whoever holds a snapshot keeps it alive for as long as they are reading it.
+	using SceneSnapshot = std::shared_ptr<const Scene>;
+
+	[[nodiscard]] inline SceneSnapshot makeSnapshot(Scene scene) {
+		if (scene.lightTree == nullptr && !(scene.pointLights.empty() && scene.sphereLights.empty())) {
+			scene.lightTree = LightTree::build(scene.pointLights, scene.sphereLights);
+		}
+		if (scene.wideSphereBVH == nullptr && scene.spheres.size() >= sphereBVHMinimumSpheres) {
+			// A binary tree built here is only needed to collapse the wide one, a static scene never refits it
+			const std::shared_ptr<const SphereBVH> binary = scene.sphereBVH != nullptr ? scene.sphereBVH : SphereBVH::build(scene.spheres);
+			scene.wideSphereBVH = WideSphereBVH::collapse(*binary);
+		}
+		return std::make_shared<const Scene>(std::move(scene));
+	}
+
+	// Edits never touch a published snapshot, they build the next one from a copy
+	template<typename Edit>
+	[[nodiscard]] SceneSnapshot editSnapshot(const SceneSnapshot& snapshot, Edit&& edit) {
+		Scene next = snapshot ? *snapshot : Scene{};
+		next.lightTree = nullptr;
+		next.sphereBVH = nullptr;
+		next.wideSphereBVH = nullptr;
+		edit(next);
+		return makeSnapshot(std::move(next));
+	}
+}
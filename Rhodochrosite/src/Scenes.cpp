@@ -4,11 +4,12 @@
 
 namespace Rhodochrosite {
 	Scenes::Scenes()
-		: oneSphere(oneSphereInit())
-		, sphereOnPlane(sphereOnPlaneInit())
-		, twoSpheres(twoSpheresInit())
-		, lotsOfSpheres(lotsOfSpheresInit())
-		, randomSpheres(randomSpheresInit()) {
+		: oneSphere(makeSnapshot(oneSphereInit()))
+		, sphereOnPlane(makeSnapshot(sphereOnPlaneInit()))
+		, twoSpheres(makeSnapshot(twoSpheresInit()))
+		, lotsOfSpheres(makeSnapshot(lotsOfSpheresInit()))
+		, randomSpheres(makeSnapshot(randomSpheresInit()))
+		, manyLights(makeSnapshot(manyLightsInit())) {
 
 	}
 
@@ -22,7 +23,7 @@ namespace Rhodochrosite {
 	Scene Scenes::sphereOnPlaneInit() {
 		Scene scene;
 		scene.spheres.emplace_back(Sphere{ Malachite::Vector3f{0.0f, 0.0f, -2.0f}, 0.5f, Ruby::Colour::pink, Material::DIFFUSE });
-		scene.spheres.emplace_back(Sphere{ Malachite::Vector3f{0.0f, -1000.5f, 0.0f}, 1000.0f, Ruby::Colour{88, 104, 117} }); // Floor
+		scene.planes.emplace_back(Plane{ Malachite::Vector3f{0.0f, -0.5f, 0.0f}, Malachite::Vector3f::up, Ruby::Colour{88, 104, 117} }); // Floor
 		scene.lights.emplace_back(Ruby::DirectionalLight{ Malachite::Vector3f{-1.0f, -1.0f, -1.0f}.normalize() });
 		return scene;
 	}
@@ -38,7 +39,7 @@ namespace Rhodochrosite {
 
 	Scene Scenes::lotsOfSpheresInit() {
 		Scene scene;
-		scene.spheres.emplace_back(Sphere{ Malachite::Vector3f{0.0f, -1000.5f, 0.0f}, 1000.0f, Ruby::Colour{88, 104, 117} }); // Floor
+		scene.planes.emplace_back(Plane{ Malachite::Vector3f{0.0f, -0.5f, 0.0f}, Malachite::Vector3f::up, Ruby::Colour{88, 104, 117} }); // Floor
 		scene.spheres.emplace_back(Sphere{ Malachite::Vector3f{-3.0f, 1.0f, -5.0f}, 0.5f, Ruby::Colour{11, 191, 77}, Material::REFLECTION });
 		scene.spheres.emplace_back(Sphere{ Malachite::Vector3f{-2.0f, 0.25f, -6.5f}, 0.25f, Ruby::Colour{68, 70, 112}, Material::DIFFUSE });
 		scene.spheres.emplace_back(Sphere{ Malachite::Vector3f{1.5f, 0.5f, -5.0f}, 1.0f, Ruby::Colour{74, 67, 16}, Material::REFLECTION });
@@ -57,7 +58,7 @@ namespace Rhodochrosite {
 
 	Scene Scenes::randomSpheresInit() {
 		Scene scene;
-		scene.spheres.emplace_back(Sphere{ Malachite::Vector3f{0.0f, -1000.5f, 0.0f}, 1000.0f, Ruby::Colour{88, 104, 117} }); // Floor
+		scene.planes.emplace_back(Plane{ Malachite::Vector3f{0.0f, -0.5f, 0.0f}, Malachite::Vector3f::up, Ruby::Colour{88, 104, 117} }); // Floor
 
 		Material mat = Material::DIFFUSE;
 		const auto numberOfSpheres = Malachite::random<unsigned int>(20, 25);
@@ -89,8 +90,49 @@ namespace Rhodochrosite {
 		return scene;
 	}
 
+	Scene Scenes::manyLightsInit() {
+		Scene scene;
+		scene.planes.emplace_back(Plane{ Malachite::Vector3f{0.0f, -0.5f, 0.0f}, Malachite::Vector3f::up, Ruby::Colour{88, 104, 117} }); // Floor
+		scene.spheres.emplace_back(Sphere{ Malachite::Vector3f{-1.5f, 0.5f, -6.0f}, 1.0f, Ruby::Colour::white, Material::DIFFUSE });
+		scene.spheres.emplace_back(Sphere{ Malachite::Vector3f{1.5f, 0.25f, -5.0f}, 0.75f, Ruby::Colour::white, Material::DIFFUSE });
+
+		// A field of small coloured lights hovering over the floor
+		for (unsigned int i = 0; i < 2000; i++) {
+			const Malachite::Vector3f position{ Malachite::random<float>(-10.0f, 10.0f), Malachite::random<float>(-0.4f, 3.0f), Malachite::random<float>(-25.0f, -1.0f) };
+			const Malachite::Vector3f colour{ Malachite::random<float>(0.2f, 1.0f), Malachite::random<float>(0.2f, 1.0f), Malachite::random<float>(0.2f, 1.0f) };
+
+			if (i % 4 == 0) {
+				scene.sphereLights.emplace_back(SphereLight{ position, 0.1f, colour, 0.05f });
+			}
+			else {
+				scene.pointLights.emplace_back(PointLight{ position, colour, 0.02f });
+			}
+		}
+
+		scene.lights.emplace_back(Ruby::DirectionalLight{ Malachite::Vector3f{-1.0f, -1.0f, -1.0f}.normalize() });
+		return scene;
+	}
+
 	void Scenes::regenerateRandomSpheres() {
-		randomSpheres = randomSpheresInit();
+		randomSpheres = makeSnapshot(randomSpheresInit());
+	}
+
+	SceneSnapshot Scenes::get(const SceneName name) const {
+		switch (name) {
+		default:
+		case SceneName::ONE_SPHERE:
+			return oneSphere;
+		case SceneName::SPHERE_ON_PLANE:
+			return sphereOnPlane;
+		case SceneName::TWO_SPHERE:
+			return twoSpheres;
+		case SceneName::LARGE_AMOUNT_OF_SPHERES:
+			return lotsOfSpheres;
+		case SceneName::RANDOM_SPHERES:
+			return randomSpheres;
+		case SceneName::MANY_LIGHTS:
+			return manyLights;
+		}
 	}
 
 }
\ No newline at end of file
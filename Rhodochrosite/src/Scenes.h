@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Rendering/Renderer.h"
 #include "Scene.h"
 
 namespace Rhodochrosite {
@@ -7,19 +8,23 @@ namespace Rhodochrosite {
 	public:
 		Scenes();
 
-		Scene oneSphere;
-		Scene sphereOnPlane;
-		Scene twoSpheres;
-		Scene lotsOfSpheres;
-		Scene randomSpheres;
+		SceneSnapshot oneSphere;
+		SceneSnapshot sphereOnPlane;
+		SceneSnapshot twoSpheres;
+		SceneSnapshot lotsOfSpheres;
+		SceneSnapshot randomSpheres;
+		SceneSnapshot manyLights;
 
 		void regenerateRandomSpheres();
 
+		[[nodiscard]] SceneSnapshot get(SceneName name) const;
+
 	private:
 		static Scene oneSphereInit();
 		static Scene sphereOnPlaneInit();
 		static Scene twoSpheresInit();
 		static Scene lotsOfSpheresInit();
 		static Scene randomSpheresInit();
+		static Scene manyLightsInit();
 	};
 }
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace Rhodochrosite {
+	// Bounded multi producer / multi consumer queue used to hand work between pipeline stages.
+	// Once closed, pop() drains the remaining items and then returns std::nullopt.
+	template<typename T>
+	class BlockingQueue {
+	public:
+		explicit BlockingQueue(const size_t capacity)
+			: m_Capacity(capacity == 0 ? 1 : capacity) { }
+
+		bool push(T value) {
+			std::unique_lock<std::mutex> lock{ m_Mutex };
+			m_NotFull.wait(lock, [this]() { return m_Closed || m_Items.size() < m_Capacity; });
+			if (m_Closed) {
+				return false;
+			}
+
+			m_Items.push_back(std::move(value));
+			lock.unlock();
+			m_NotEmpty.notify_one();
+			return true;
+		}
+
+		[[nodiscard]] std::optional<T> pop() {
+			std::unique_lock<std::mutex> lock{ m_Mutex };
+			m_NotEmpty.wait(lock, [this]() { return m_Closed || !m_Items.empty(); });
+			if (m_Items.empty()) {
+				return std::nullopt;
+			}
+
+			T value = std::move(m_Items.front());
+			m_Items.pop_front();
+			lock.unlock();
+			m_NotFull.notify_one();
+			return value;
+		}
+
+		void close() {
+			{
+				std::lock_guard<std::mutex> lock{ m_Mutex };
+				m_Closed = true;
+			}
+			m_NotEmpty.notify_all();
+			m_NotFull.notify_all();
+		}
+
+	private:
+		std::mutex m_Mutex;
+		std::condition_variable m_NotEmpty;
+		std::condition_variable m_NotFull;
+		std::deque<T> m_Items;
+		size_t m_Capacity;
+		bool m_Closed{ false };
+	};
+}
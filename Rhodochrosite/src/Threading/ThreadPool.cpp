@@ -0,0 +1,91 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace Rhodochrosite {
+	ThreadPool::ThreadPool(const unsigned int threadCount) {
+		const unsigned int count = std::max(threadCount, 1u);
+		m_Threads.reserve(count);
+		for (unsigned int i = 0; i < count; i++) {
+			m_Threads.emplace_back([this]() { workerLoop(); });
+		}
+	}
+
+	ThreadPool::~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock{ m_Mutex };
+			m_Stopping = true;
+		}
+		m_TaskAvailable.notify_all();
+
+		for (std::thread& thread : m_Threads) {
+			thread.join();
+		}
+	}
+
+	void ThreadPool::submit(std::function<void()> task) {
+		{
+			std::lock_guard<std::mutex> lock{ m_Mutex };
+			m_Tasks.push_back(std::move(task));
+		}
+		m_TaskAvailable.notify_one();
+	}
+
+	namespace {
+		std::atomic<unsigned int> sharedThreadCount{ 0 };
+	}
+
+	ThreadPool& ThreadPool::shared() {
+		static ThreadPool pool{ sharedThreadCount == 0 ? std::thread::hardware_concurrency() : sharedThreadCount.load() };
+		return pool;
+	}
+
+	void ThreadPool::setSharedThreadCount(const unsigned int threadCount) {
+		sharedThreadCount = threadCount;
+	}
+
+	void ThreadPool::workerLoop() {
+		while (true) {
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock{ m_Mutex };
+				m_TaskAvailable.wait(lock, [this]() { return m_Stopping || !m_Tasks.empty(); });
+				if (m_Tasks.empty()) {
+					return;
+				}
+
+				task = std::move(m_Tasks.front());
+				m_Tasks.pop_front();
+			}
+
+			task();
+		}
+	}
+
+	void TaskGroup::run(ThreadPool& pool, std::function<void()> task) {
+		{
+			std::lock_guard<std::mutex> lock{ m_Mutex };
+			m_Pending++;
+		}
+
+		pool.submit([this, task = std::move(task)]() {
+			task();
+
+			std::lock_guard<std::mutex> lock{ m_Mutex };
+			if (--m_Pending == 0) {
+				m_Done.notify_all();
+			}
+		});
+	}
+
+	void TaskGroup::wait() {
+		std::unique_lock<std::mutex> lock{ m_Mutex };
+		m_Done.wait(lock, [this]() { return m_Pending == 0; });
+	}
+
+	bool TaskGroup::isDone() {
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		return m_Pending == 0;
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Rhodochrosite {
+	class ThreadPool {
+	public:
+		explicit ThreadPool(unsigned int threadCount = std::thread::hardware_concurrency());
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool& other) = delete;
+		ThreadPool& operator=(const ThreadPool& other) = delete;
+
+		void submit(std::function<void()> task);
+
+		[[nodiscard]] unsigned int getThreadCount() const { return static_cast<unsigned int>(m_Threads.size()); }
+
+		// Pool shared by every renderer that is not given its own
+		[[nodiscard]] static ThreadPool& shared();
+		// Threads the shared pool starts with, 0 for one per hardware thread. No effect once shared() has been called.
+		static void setSharedThreadCount(unsigned int threadCount);
+
+	private:
+		std::vector<std::thread> m_Threads;
+		std::deque<std::function<void()>> m_Tasks;
+		std::mutex m_Mutex;
+		std::condition_variable m_TaskAvailable;
+		bool m_Stopping{ false };
+
+		void workerLoop();
+	};
+
+	// Tracks a set of tasks submitted to a pool so their submitter can wait for just those
+	class TaskGroup {
+	public:
+		TaskGroup() = default;
+		~TaskGroup() { wait(); }
+
+		TaskGroup(const TaskGroup& other) = delete;
+		TaskGroup& operator=(const TaskGroup& other) = delete;
+
+		void run(ThreadPool& pool, std::function<void()> task);
+		void wait();
+		[[nodiscard]] bool isDone();
+
+	private:
+		std::mutex m_Mutex;
+		std::condition_variable m_Done;
+		unsigned int m_Pending{ 0 };
+	};
+}